@@ -26,15 +26,23 @@
 #include <pc/transpose.hpp>
 #include <pc/benchmarks.hpp>
 #include <pc/check_symm.hpp>
+#include <pc/simd.hpp>
+#include <pc/numa.hpp>
+#include <pc/arena.hpp>
 #include <mpi.h>
 #include <tenno/ranges.hpp>
 #include <tenno/random.hpp>
 #include <valfuzz/valfuzz.hpp>
 
+#include <complex>
 #include <iostream>
-#include <cstdlib>    /* exit */
+#include <string>
+#include <cstdlib>    /* exit, aligned_alloc, getenv */
+#include <cstring>
+#include <cstdint>    /* SIZE_MAX */
+#include <vector>
 
-#define PC_MATRIX_MAX_SIZE 1<<12
+#define PC_MATRIX_MAX_SIZE (1<<12)
 #define PC_RANDOM_MATRIX_SIZE 256
 
 
@@ -70,9 +78,68 @@ constexpr tenno::array<float, PC_RANDOM_MATRIX_SIZE> random_arr2()
     return tenno::random_array<PC_RANDOM_MATRIX_SIZE>(seed2, min, max);
 }
 
+/*
+ * Backing of the benchmark matrices: regular pages by default,
+ * 2 MiB pages when PC_HUGE_PAGES=1 is in the environment, so every
+ * kernel can be compared on both. The arena holds the two global
+ * matrices and the two largest flat ones of a benchmark, those of
+ * pitch_benchmark; an allocation that does not fit is reported.
+ * pc::Matrix keeps its own allocation.
+ */
+static pc::Arena *huge_arena = nullptr;
+
+static void bench_init_backing()
+{
+  const char *env = std::getenv("PC_HUGE_PAGES");
+  if (env == nullptr || std::strcmp(env, "1") != 0)
+    return;
+
+  const tenno::size global = PC_MATRIX_MAX_SIZE * PC_MATRIX_MAX_SIZE;
+  const tenno::size flat = PC_MATRIX_MAX_SIZE
+    * pc::paddedPitch(PC_MATRIX_MAX_SIZE);
+  /* 64 bytes of alignment per allocation */
+  huge_arena = new pc::Arena(2 * sizeof(float) * (global + flat) + 4 * 64);
+  std::cerr << "Benchmark matrices on "
+	    << (huge_arena->huge() ? "huge pages" : "regular pages (no huge page support)")
+	    << std::endl;
+}
+
+/* 64 byte aligned on both backings */
+float *bench_alloc(tenno::size count)
+{
+  const tenno::size bytes = (count * sizeof(float) + 63) / 64 * 64;
+  if (huge_arena != nullptr)
+    {
+      void *p = huge_arena->allocate(bytes);
+      if (p != nullptr)
+	return static_cast<float*>(p);
+      std::cerr << "Arena full, " << bytes
+		<< " bytes on regular pages" << std::endl;
+    }
+  return static_cast<float*>(std::aligned_alloc(64, bytes));
+}
+
+/* Matrices of the arena are released with everything allocated
+ * after them, as the benchmarks free them in order */
+void bench_free(float *p)
+{
+  if (huge_arena != nullptr && huge_arena->owns(p))
+    huge_arena->release(p);
+  else
+    std::free(p);
+}
+
 pc::matrix matrix_alloc(tenno::size N)
 {
   pc::matrix M = new float*[N];
+  if (huge_arena != nullptr)
+    {
+      /* One block, so that the rows share the huge pages */
+      float *block = bench_alloc(N * N);
+      for (unsigned int i = 0; i < N; ++i)
+	M[i] = block + i * N;
+      return M;
+    }
   for (unsigned int i = 0; i < N; ++i)
     {
       M[i] = new float[N];
@@ -97,16 +164,31 @@ void matrix_init(pc::matrix M, tenno::size N)
       }
 }
 
+void matrix_init(pc::Matrix &M)
+{
+  constexpr auto arr1 = random_arr1();
+  constexpr auto arr2 = random_arr2();
+
+  for (const auto i : tenno::range(M.rows()))
+    for (const auto j : tenno::range(M.cols()))
+      M[i][j] = arr1[i % PC_RANDOM_MATRIX_SIZE] +
+	arr2[j % PC_RANDOM_MATRIX_SIZE];
+}
+
 void matrix_free(pc::matrix M, tenno::size N)
 {
-  for (unsigned int i = 0; i < N; ++i)
-    delete[] M[i];
+  if (huge_arena != nullptr && huge_arena->owns(M[0]))
+    bench_free(M[0]);
+  else
+    for (unsigned int i = 0; i < N; ++i)
+      delete[] M[i];
   delete[]  M;
 }
 
 /* Execute this before any benchmark */
 BEFORE()
 {
+  bench_init_backing();
   pc::matrix_in = matrix_alloc(PC_MATRIX_MAX_SIZE);
   matrix_init(pc::matrix_in, PC_MATRIX_MAX_SIZE);
   pc::matrix_out = matrix_alloc(PC_MATRIX_MAX_SIZE);
@@ -127,6 +209,7 @@ AFTER()
 {
   matrix_free(pc::matrix_in, PC_MATRIX_MAX_SIZE);
   matrix_free(pc::matrix_out, PC_MATRIX_MAX_SIZE);
+  delete huge_arena;
 
   /* Stop the worker */
   char fin[10] = "";
@@ -140,91 +223,857 @@ AFTER()
 |                   TRANSPOSE                  |
 \*============================================*/
 
-// Sequencial
+// Sequencial
+
+BENCHMARK(transpose_benchmark,
+	  "matTranspose")
+{
+  for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTranspose(pc::matrix_in, pc::matrix_out, (1<<N)));
+    }
+}
+
+BENCHMARK(transpose_half_benchmark,
+	  "matTransposeHalf")
+{
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeHalf(pc::matrix_in, pc::matrix_out, (1<<N)));
+    }
+}
+
+BENCHMARK(transpose_columns_benchmark,
+	  "matTransposeColumns")
+{
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeColumns(pc::matrix_in, pc::matrix_out, (1<<N)));
+    }
+}
+
+BENCHMARK(transpose_cyclic_benchmark,
+	  "matTransposeCyclic")
+{
+    /* Initialize the vector */
+    float* arr_in = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    float* arr_out = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      arr_in[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+      
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeCyclic(arr_in, arr_out, (1<<N)));
+    }
+
+    bench_free(arr_in);
+    bench_free(arr_out);
+}
+
+BENCHMARK(transpose_4x4_intrinsic_cyclic_benchmark,
+	  "matTransposeIntrinsicCyclic")
+{
+    /* Initialize the vector */
+    float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    float* T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+      
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeIntrinsicCyclic(M_cyclic, T_cyclic, (1<<N)));
+    }
+    bench_free(M_cyclic);
+    bench_free(T_cyclic);
+}
+
+/* Same kernel forcing the narrower instruction sets */
+static void transpose_intrinsic_cyclic_level(const std::string& benchmark_name,
+					     pc::SimdLevel level)
+{
+    float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    float* T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+    const pc::SimdLevel native = pc::simdLevel();
+    pc::setSimdLevel(level);
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeIntrinsicCyclic(M_cyclic, T_cyclic, (1<<N)));
+    }
+    pc::setSimdLevel(native);
+
+    bench_free(M_cyclic);
+    bench_free(T_cyclic);
+}
+
+BENCHMARK(transpose_intrinsic_cyclic_sse_benchmark,
+	  "matTransposeIntrinsicCyclic SSE")
+{
+    transpose_intrinsic_cyclic_level(benchmark_name, pc::SimdLevel::SSE);
+}
+
+BENCHMARK(transpose_intrinsic_cyclic_avx2_benchmark,
+	  "matTransposeIntrinsicCyclic AVX2")
+{
+    transpose_intrinsic_cyclic_level(benchmark_name, pc::SimdLevel::AVX2);
+}
+
+BENCHMARK(transpose_intrinsic_cyclic_odd_benchmark,
+	  "matTransposeIntrinsicCyclic odd N")
+{
+    /* N = 2^k - 1, every tile row and column has a masked edge */
+    float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    float* T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N) - 1,
+		    pc::matTransposeIntrinsicCyclic(M_cyclic, T_cyclic, (1<<N) - 1));
+    }
+    bench_free(M_cyclic);
+    bench_free(T_cyclic);
+}
+
+/* Regular against non-temporal stores on the same buffers. Each
+ * call moves 2 * N * N * sizeof(float) bytes, divide by the time to
+ * get the effective bandwidth. */
+static void transpose_intrinsic_cyclic_threshold(const std::string& benchmark_name,
+						 tenno::size threshold)
+{
+  const tenno::size old_threshold = pc::streamThreshold();
+  pc::setStreamThreshold(threshold);
+
+  float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+  float* T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+  constexpr auto arr1 = random_arr1();
+
+  for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+    M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+  for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeIntrinsicCyclic(M_cyclic, T_cyclic, (1<<N)));
+    }
+  bench_free(M_cyclic);
+  bench_free(T_cyclic);
+  pc::setStreamThreshold(old_threshold);
+}
+
+BENCHMARK(transpose_intrinsic_cyclic_store_benchmark,
+	  "matTransposeIntrinsicCyclic regular stores")
+{
+  transpose_intrinsic_cyclic_threshold(benchmark_name, SIZE_MAX);
+}
+
+BENCHMARK(transpose_intrinsic_cyclic_stream_benchmark,
+	  "matTransposeIntrinsicCyclic streaming stores")
+{
+  transpose_intrinsic_cyclic_threshold(benchmark_name, 0);
+}
+
+BENCHMARK(transpose_4x4_intrinsic_benchmark,
+	  "matTransposeIntrinsic")
+{
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeIntrinsic(pc::matrix_in, pc::matrix_out, (1<<N)));
+    }
+}
+
+BENCHMARK(transpose_prefetch_benchmark,
+	  "matTransposePrefetch")
+{
+  for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposePrefetch(pc::matrix_in, pc::matrix_out,
+					     (1<<N)));
+    }
+}
+
+BENCHMARK(transpose_intrinsic_prefetch_benchmark,
+	  "matTransposeIntrinsicPrefetch")
+{
+  for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeIntrinsicPrefetch(pc::matrix_in,
+						      pc::matrix_out,
+						      (1<<N)));
+    }
+}
+
+/* The following sweep the prefetch distance on the largest matrix,
+ * the input size reported is the distance, 0 meaning no prefetch */
+
+BENCHMARK(transpose_prefetch_distance_benchmark,
+	  "matTransposePrefetch distance")
+{
+  for (size_t distance : {0, 1, 2, 4, 8, 16, 32, 64})
+    {
+      RUN_BENCHMARK(distance,
+		    pc::matTransposePrefetch(pc::matrix_in, pc::matrix_out,
+					     PC_MATRIX_MAX_SIZE, distance));
+    }
+}
+
+BENCHMARK(transpose_intrinsic_prefetch_distance_benchmark,
+	  "matTransposeIntrinsicPrefetch distance")
+{
+  for (size_t distance : {0, 1, 2, 4, 8, 16, 32, 64})
+    {
+      RUN_BENCHMARK(distance,
+		    pc::matTransposeIntrinsicPrefetch(pc::matrix_in,
+						      pc::matrix_out,
+						      PC_MATRIX_MAX_SIZE,
+						      distance));
+    }
+}
+
+BENCHMARK(transpose_matrix_type_benchmark,
+	  "matTranspose pc::Matrix")
+{
+  for (size_t N = 2; N <= 12; ++N)
+    {
+      pc::Matrix M(1<<N);
+      pc::Matrix T(1<<N);
+      matrix_init(M);
+      RUN_BENCHMARK((1<<N),
+		    pc::matTranspose(M, T));
+    }
+}
+
+BENCHMARK(transpose_matrix_type_padded_benchmark,
+	  "matTranspose pc::Matrix padded")
+{
+  for (size_t N = 2; N <= 12; ++N)
+    {
+      pc::Matrix M(1<<N, pc::Padding::Auto);
+      pc::Matrix T(1<<N, pc::Padding::Auto);
+      matrix_init(M);
+      RUN_BENCHMARK((1<<N),
+		    pc::matTranspose(M, T));
+    }
+}
+
+BENCHMARK(transpose_intrinsic_matrix_type_benchmark,
+	  "matTransposeIntrinsic pc::Matrix")
+{
+  for (size_t N = 2; N <= 12; ++N)
+    {
+      pc::Matrix M(1<<N);
+      pc::Matrix T(1<<N);
+      matrix_init(M);
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeIntrinsic(M, T));
+    }
+}
+
+/* The same kernel with rows 2^k floats apart and with the pitch
+ * padded by the library, on the same buffers */
+template <typename Kernel>
+static void pitch_benchmark(const std::string& benchmark_name, bool padded,
+			    Kernel kernel)
+{
+  const tenno::size ld_max = pc::paddedPitch(PC_MATRIX_MAX_SIZE);
+  float* M = bench_alloc(PC_MATRIX_MAX_SIZE*ld_max);
+  float* T = bench_alloc(PC_MATRIX_MAX_SIZE*ld_max);
+
+  constexpr auto arr1 = random_arr1();
+
+  for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*ld_max; ++i)
+    M[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+  for (size_t N = 2; N <= 12; ++N)
+    {
+      const tenno::size ld = padded ? pc::paddedPitch(1<<N) : (1<<N);
+      RUN_BENCHMARK((1<<N),
+		    kernel(M, T, (1<<N), ld));
+    }
+  bench_free(M);
+  bench_free(T);
+}
+
+static void transpose_cyclic_pitch(float *M, float *T, tenno::size N,
+				   tenno::size ld)
+{
+  pc::matTransposeCyclic(M, T, N, ld, ld);
+}
+
+static void transpose_intrinsic_cyclic_pitch(float *M, float *T,
+					     tenno::size N, tenno::size ld)
+{
+  pc::matTransposeIntrinsicCyclic(M, T, N, ld, ld);
+}
+
+static void check_sym_columns_pitch(float *M, float *, tenno::size N,
+				    tenno::size ld)
+{
+  pc::checkSymColumns(M, N, ld);
+}
+
+BENCHMARK(transpose_cyclic_pitch_benchmark,
+	  "matTransposeCyclic 2^k pitch")
+{
+  pitch_benchmark(benchmark_name, false, transpose_cyclic_pitch);
+}
+
+BENCHMARK(transpose_cyclic_padded_benchmark,
+	  "matTransposeCyclic padded pitch")
+{
+  pitch_benchmark(benchmark_name, true, transpose_cyclic_pitch);
+}
+
+BENCHMARK(transpose_intrinsic_cyclic_pitch_benchmark,
+	  "matTransposeIntrinsicCyclic 2^k pitch")
+{
+  pitch_benchmark(benchmark_name, false, transpose_intrinsic_cyclic_pitch);
+}
+
+BENCHMARK(transpose_intrinsic_cyclic_padded_benchmark,
+	  "matTransposeIntrinsicCyclic padded pitch")
+{
+  pitch_benchmark(benchmark_name, true, transpose_intrinsic_cyclic_pitch);
+}
+
+BENCHMARK(check_sym_columns_pitch_benchmark,
+	  "checkSymColumns 2^k pitch")
+{
+  pitch_benchmark(benchmark_name, false, check_sym_columns_pitch);
+}
+
+BENCHMARK(check_sym_columns_padded_benchmark,
+	  "checkSymColumns padded pitch")
+{
+  pitch_benchmark(benchmark_name, true, check_sym_columns_pitch);
+}
+
+BENCHMARK(transpose_strided_benchmark,
+	  "matTransposeStrided")
+{
+    /* The top left 2^N x 2^N block of the full buffer, no copy */
+    float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    float* T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeStrided(M_cyclic, (1<<N), (1<<N),
+					    PC_MATRIX_MAX_SIZE,
+					    T_cyclic, PC_MATRIX_MAX_SIZE));
+    }
+    bench_free(M_cyclic);
+    bench_free(T_cyclic);
+}
+
+BENCHMARK(transpose_fixed_benchmark,
+	  "matTransposeFixed")
+{
+    /* Unrolled instances up to 64, matTransposeStrided above */
+    float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    float* T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeFixed(M_cyclic, T_cyclic, (1<<N)));
+    }
+    bench_free(M_cyclic);
+    bench_free(T_cyclic);
+}
+
+/* What matTransposeBatch replaces */
+static void transpose_each(float *M, float *T, size_t N, size_t count)
+{
+  for (size_t k = 0; k < count; ++k)
+    pc::matTransposeIntrinsicCyclic(M + k*N*N, T + k*N*N, N);
+}
+
+/* The same buffer cut into as many N x N matrices as fit */
+static void transpose_batch(const std::string& benchmark_name, bool batch)
+{
+    const size_t size = PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE;
+    float* M_cyclic = bench_alloc(size);
+    float* T_cyclic = bench_alloc(size);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < size; ++i)
+      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+    for (size_t N = 2; N <= 6; ++N)
+    {
+      const size_t n = 1<<N;
+      const size_t count = size / (n*n);
+      if (batch)
+      {
+        RUN_BENCHMARK((1<<N),
+		      pc::matTransposeBatch(M_cyclic, T_cyclic, n, count));
+      }
+      else
+      {
+        RUN_BENCHMARK((1<<N),
+		      transpose_each(M_cyclic, T_cyclic, n, count));
+      }
+    }
+    bench_free(M_cyclic);
+    bench_free(T_cyclic);
+}
+
+BENCHMARK(transpose_batch_loop_benchmark,
+	  "matTransposeIntrinsicCyclic per matrix of a batch")
+{
+  transpose_batch(benchmark_name, false);
+}
+
+BENCHMARK(transpose_batch_benchmark,
+	  "matTransposeBatch")
+{
+  transpose_batch(benchmark_name, true);
+}
+
+/* matTransposeStrided on square matrices of another element type */
+template <typename T, bool Conj = false>
+static void transpose_type_benchmark(const std::string& benchmark_name)
+{
+  std::vector<T> M(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+  std::vector<T> T_out(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+  constexpr auto arr1 = random_arr1();
+
+  for (size_t i = 0; i < M.size(); ++i)
+    M[i] = T(arr1[i % PC_RANDOM_MATRIX_SIZE] * 100);
+
+  for (size_t N = 2; N <= 12; ++N)
+    {
+      if constexpr (Conj)
+	RUN_BENCHMARK((1<<N),
+		      pc::matTransposeConj(M.data(), (1<<N), (1<<N), (1<<N),
+					   T_out.data(), (1<<N)));
+      else
+	RUN_BENCHMARK((1<<N),
+		      pc::matTransposeStrided(M.data(), (1<<N), (1<<N), (1<<N),
+					      T_out.data(), (1<<N)));
+    }
+}
+
+BENCHMARK(transpose_double_benchmark,
+	  "matTransposeStrided double")
+{
+  transpose_type_benchmark<double>(benchmark_name);
+}
+
+BENCHMARK(transpose_uint16_benchmark,
+	  "matTransposeStrided uint16_t")
+{
+  transpose_type_benchmark<uint16_t>(benchmark_name);
+}
+
+BENCHMARK(transpose_int8_benchmark,
+	  "matTransposeStrided int8_t")
+{
+  transpose_type_benchmark<int8_t>(benchmark_name);
+}
+
+BENCHMARK(transpose_complex_benchmark,
+	  "matTransposeStrided complex<float>")
+{
+  transpose_type_benchmark<std::complex<float>>(benchmark_name);
+}
+
+BENCHMARK(transpose_conj_benchmark,
+	  "matTransposeConj complex<float>")
+{
+  transpose_type_benchmark<std::complex<float>, true>(benchmark_name);
+}
+
+BENCHMARK(transpose_in_place_benchmark,
+	  "matTransposeInPlace")
+{
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeInPlace(pc::matrix_out, (1<<N)));
+    }
+}
+
+BENCHMARK(transpose_in_place_cyclic_benchmark,
+	  "matTransposeInPlace cyclic")
+{
+    float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeInPlace(M_cyclic, (1<<N)));
+    }
+    bench_free(M_cyclic);
+}
+
+BENCHMARK(transpose_in_place_rectangular_benchmark,
+	  "matTransposeInPlace rectangular")
+{
+    /* 2^N x 2^(N-1) matrices */
+    float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeInPlace(M_cyclic, (1<<N), (1<<(N-1))));
+    }
+    bench_free(M_cyclic);
+}
+
+/* (2^N + 1) x (2^N - 1) matrices, whose sides are coprime, in place
+ * and out of place */
+BENCHMARK(transpose_in_place_coprime_benchmark,
+	  "matTransposeInPlace coprime")
+{
+    float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeInPlace(M_cyclic, (1<<N) + 1, (1<<N) - 1));
+    }
+    bench_free(M_cyclic);
+}
+
+BENCHMARK(transpose_strided_coprime_benchmark,
+	  "matTransposeStrided coprime")
+{
+    float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    float* T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeStrided(M_cyclic, (1<<N) + 1, (1<<N) - 1,
+					    (1<<N) - 1, T_cyclic, (1<<N) + 1));
+    }
+    bench_free(M_cyclic);
+    bench_free(T_cyclic);
+}
+
+BENCHMARK(transpose_recursive_benchmark,
+	  "matTransposeRecursive")
+{
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeRecursive(pc::matrix_in, pc::matrix_out, (1<<N)));
+    }
+}
+
+BENCHMARK(transpose_recursive_cyclic_benchmark,
+	  "matTransposeRecursiveCyclic")
+{
+    /* Initialize the vector */
+    float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    float* T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+      
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeRecursiveCyclic(M_cyclic, T_cyclic, (1<<N)));
+    }
+    bench_free(M_cyclic);
+    bench_free(T_cyclic);
+}
+
+// OMP
+
+/* Thread counts 1, 2, 4, ... up to and including omp_get_max_threads() */
+static std::vector<int> omp_thread_counts()
+{
+  std::vector<int> counts;
+  const int max_threads = omp_get_max_threads();
+  for (int t = 1; t < max_threads; t *= 2)
+    counts.push_back(t);
+  counts.push_back(max_threads);
+  return counts;
+}
+
+static void transpose_intrinsic_cyclic_omp_schedule(const std::string& benchmark_name,
+						    const pc::OmpOptions &opts)
+{
+  float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+  float* T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+  constexpr auto arr1 = random_arr1();
+
+  for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+    M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+  for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::matTransposeIntrinsicCyclicOMP(M_cyclic, T_cyclic,
+						       (1<<N), opts));
+    }
+  bench_free(M_cyclic);
+  bench_free(T_cyclic);
+}
+
+BENCHMARK(transpose_intrinsic_cyclic_omp_static_benchmark,
+	  "matTransposeIntrinsicCyclicOMP static")
+{
+  transpose_intrinsic_cyclic_omp_schedule(benchmark_name, {pc::OmpSchedule::Static, 0, 1, 0});
+}
+
+BENCHMARK(transpose_intrinsic_cyclic_omp_dynamic_benchmark,
+	  "matTransposeIntrinsicCyclicOMP dynamic")
+{
+  transpose_intrinsic_cyclic_omp_schedule(benchmark_name, {pc::OmpSchedule::Dynamic, 1, 1, 0});
+}
+
+BENCHMARK(transpose_intrinsic_cyclic_omp_guided_benchmark,
+	  "matTransposeIntrinsicCyclicOMP guided")
+{
+  transpose_intrinsic_cyclic_omp_schedule(benchmark_name, {pc::OmpSchedule::Guided, 0, 1, 0});
+}
+
+BENCHMARK(transpose_intrinsic_cyclic_omp_collapse_benchmark,
+	  "matTransposeIntrinsicCyclicOMP collapse(2)")
+{
+  transpose_intrinsic_cyclic_omp_schedule(benchmark_name, {pc::OmpSchedule::Static, 0, 2, 0});
+}
+
+/* The following sweep the number of threads on the largest matrix,
+ * the input size reported is the thread count */
+
+BENCHMARK(transpose_cyclic_omp_threads_benchmark,
+	  "matTransposeCyclicOMP threads")
+{
+  float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+  float* T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+  constexpr auto arr1 = random_arr1();
+
+  for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+    M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
 
-BENCHMARK(transpose_benchmark,
-	  "matTranspose")
-{
-  for (size_t N = 2; N <= 12; ++N)
+  for (int threads : omp_thread_counts())
     {
-      RUN_BENCHMARK((1<<N),
-		    pc::matTranspose(pc::matrix_in, pc::matrix_out, (1<<N)));
+      RUN_BENCHMARK(threads,
+		    pc::matTransposeCyclicOMP(M_cyclic, T_cyclic,
+					      PC_MATRIX_MAX_SIZE,
+					      {pc::OmpSchedule::Static, 0, 1,
+					       threads}));
     }
+  bench_free(M_cyclic);
+  bench_free(T_cyclic);
 }
 
-BENCHMARK(transpose_half_benchmark,
-	  "matTransposeHalf")
+/* Symmetric, so every block is checked */
+static void check_sym_omp_threads(const std::string& benchmark_name,
+				  pc::OmpSchedule schedule)
 {
-    for (size_t N = 2; N <= 12; ++N)
+  float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+  for (size_t i = 0; i < PC_MATRIX_MAX_SIZE; ++i)
+    for (size_t j = 0; j < PC_MATRIX_MAX_SIZE; ++j)
+      M_cyclic[i*PC_MATRIX_MAX_SIZE + j] = float(i + j);
+
+  for (int threads : omp_thread_counts())
     {
-      RUN_BENCHMARK((1<<N),
-		    pc::matTransposeHalf(pc::matrix_in, pc::matrix_out, (1<<N)));
+      RUN_BENCHMARK(threads,
+		    pc::checkSymOMP(M_cyclic, PC_MATRIX_MAX_SIZE,
+				    PC_MATRIX_MAX_SIZE,
+				    {schedule, 0, 1, threads}));
     }
+  bench_free(M_cyclic);
 }
 
-BENCHMARK(transpose_columns_benchmark,
-	  "matTransposeColumns")
+BENCHMARK(check_sym_omp_static_threads_benchmark,
+	  "checkSymOMP static threads")
 {
-    for (size_t N = 2; N <= 12; ++N)
+  check_sym_omp_threads(benchmark_name, pc::OmpSchedule::Static);
+}
+
+BENCHMARK(check_sym_omp_dynamic_threads_benchmark,
+	  "checkSymOMP dynamic threads")
+{
+  check_sym_omp_threads(benchmark_name, pc::OmpSchedule::Dynamic);
+}
+
+BENCHMARK(transpose_intrinsic_omp_threads_benchmark,
+	  "matTransposeIntrinsicOMP threads")
+{
+  for (int threads : omp_thread_counts())
     {
-      RUN_BENCHMARK((1<<N),
-		    pc::matTransposeColumns(pc::matrix_in, pc::matrix_out, (1<<N)));
+      RUN_BENCHMARK(threads,
+		    pc::matTransposeIntrinsicOMP(pc::matrix_in, pc::matrix_out,
+						 PC_MATRIX_MAX_SIZE,
+						 {pc::OmpSchedule::Static, 0, 1,
+						  threads}));
     }
 }
 
-BENCHMARK(transpose_cyclic_benchmark,
-	  "matTransposeCyclic")
+BENCHMARK(transpose_intrinsic_cyclic_omp_threads_benchmark,
+	  "matTransposeIntrinsicCyclicOMP threads")
 {
-    /* Initialize the vector */
-    float* arr_in = new float[PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE];
-    float* arr_out = new float[PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE];
+  float* M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+  float* T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
 
-    constexpr auto arr1 = random_arr1();
+  constexpr auto arr1 = random_arr1();
 
-    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
-      arr_in[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
-      
-    for (size_t N = 2; N <= 12; ++N)
+  for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+    M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+  for (int threads : omp_thread_counts())
     {
-      RUN_BENCHMARK((1<<N),
-		    pc::matTransposeCyclic(arr_in, arr_out, (1<<N)));
+      RUN_BENCHMARK(threads,
+		    pc::matTransposeIntrinsicCyclicOMP(M_cyclic, T_cyclic,
+						       PC_MATRIX_MAX_SIZE,
+						       {pc::OmpSchedule::Static,
+							0, 1, threads}));
     }
-
-    delete[] arr_in;
-    delete[] arr_out;
+  bench_free(M_cyclic);
+  bench_free(T_cyclic);
 }
 
-BENCHMARK(transpose_4x4_intrinsic_cyclic_benchmark,
-	  "matTransposeIntrinsicCyclic")
+BENCHMARK(transpose_strided_omp_threads_benchmark,
+	  "matTransposeStridedOMP threads")
 {
-    /* Initialize the vector */
-    float* M_cyclic = new float[PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE];
-    float* T_cyclic = new float[PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE];
+  float* A = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+  float* B = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
 
-    constexpr auto arr1 = random_arr1();
+  constexpr auto arr1 = random_arr1();
 
-    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
-      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
-      
-    for (size_t N = 2; N <= 12; ++N)
+  for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+    A[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+  for (int threads : omp_thread_counts())
     {
-      RUN_BENCHMARK((1<<N),
-		    pc::matTransposeIntrinsicCyclic(M_cyclic, T_cyclic, (1<<N)));
+      RUN_BENCHMARK(threads,
+		    pc::matTransposeStridedOMP(A, PC_MATRIX_MAX_SIZE,
+					       PC_MATRIX_MAX_SIZE,
+					       PC_MATRIX_MAX_SIZE,
+					       B, PC_MATRIX_MAX_SIZE,
+					       {pc::OmpSchedule::Static, 0, 2,
+						threads}));
     }
-    delete[] M_cyclic;
-    delete[] T_cyclic;
+  bench_free(A);
+  bench_free(B);
 }
 
-BENCHMARK(transpose_4x4_intrinsic_benchmark,
-	  "matTransposeIntrinsic")
+/* Same kernel and thread count, only the placement of the pages of
+ * both matrices changes. The matrices are allocated for each N, so
+ * the first touch splits them like the kernel splits that N x N
+ * transpose. Threads are pinned so that they do not migrate away
+ * from the pages they touched, and unpinned after. */
+static void transpose_omp_placement(const std::string& benchmark_name,
+				    pc::NumaPlacement placement)
 {
-    for (size_t N = 2; N <= 12; ++N)
+  pc::ThreadPinScope pin;
+  constexpr auto arr1 = random_arr1();
+
+  for (size_t N = 2; N <= 12; ++N)
     {
+      const tenno::size n = tenno::size(1) << N;
+      float* M_cyclic = pc::numaAlloc(n, n, placement, 0,
+				      pc::NumaPartition::Rows);
+      float* T_cyclic = pc::numaAlloc(n, n, placement, 0,
+				      pc::NumaPartition::Columns);
+      if (M_cyclic == nullptr || T_cyclic == nullptr)
+	{
+	  std::cerr << "Error allocating the matrices" << std::endl;
+	  pc::numaFree(M_cyclic, n, n);
+	  pc::numaFree(T_cyclic, n, n);
+	  return;
+	}
+
+      /* The pages are already placed, this does not move them */
+      for (size_t i = 0; i < n*n; ++i)
+	M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
       RUN_BENCHMARK((1<<N),
-		    pc::matTransposeIntrinsic(pc::matrix_in, pc::matrix_out, (1<<N)));
+		    pc::matTransposeIntrinsicCyclicOMP(M_cyclic, T_cyclic,
+						       (1<<N)));
+      pc::numaFree(M_cyclic, n, n);
+      pc::numaFree(T_cyclic, n, n);
     }
 }
 
+BENCHMARK(transpose_omp_naive_placement_benchmark,
+	  "matTransposeIntrinsicCyclicOMP naive placement")
+{
+  transpose_omp_placement(benchmark_name, pc::NumaPlacement::Naive);
+}
+
+BENCHMARK(transpose_omp_local_placement_benchmark,
+	  "matTransposeIntrinsicCyclicOMP local placement")
+{
+  transpose_omp_placement(benchmark_name, pc::NumaPlacement::Local);
+}
+
+BENCHMARK(transpose_omp_interleave_placement_benchmark,
+	  "matTransposeIntrinsicCyclicOMP interleave placement")
+{
+  transpose_omp_placement(benchmark_name, pc::NumaPlacement::Interleave);
+}
+
 // MPI
 
 BENCHMARK(transpose_mpi_benchmark,
@@ -233,8 +1082,8 @@ BENCHMARK(transpose_mpi_benchmark,
     if (pc::world_rank != 0)
       return;
 
-    float *M_cyclic = new float[PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE];
-    float *T_cyclic = new float[PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE];
+    float *M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    float *T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
 
     constexpr auto arr1 = random_arr1();
 
@@ -266,8 +1115,8 @@ BENCHMARK(transpose_mpi_benchmark,
       	    pc::matTransposeMPI(M_cyclic, T_cyclic, (1<<N)));
     }
 
-    delete[] M_cyclic;
-    delete[] T_cyclic;
+    bench_free(M_cyclic);
+    bench_free(T_cyclic);
     return;
 }
 
@@ -277,8 +1126,8 @@ BENCHMARK(transpose_mpi_nonblocking_benchmark,
     if (pc::world_rank != 0)
       return;
 
-    float *M_cyclic = new float[PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE];
-    float *T_cyclic = new float[PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE];
+    float *M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    float *T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
 
     constexpr auto arr1 = random_arr1();
 
@@ -310,8 +1159,8 @@ BENCHMARK(transpose_mpi_nonblocking_benchmark,
       	    pc::matTransposeMPINonblocking(M_cyclic, T_cyclic, (1<<N)));
     }
 
-    delete[] M_cyclic;
-    delete[] T_cyclic;
+    bench_free(M_cyclic);
+    bench_free(T_cyclic);
     return;
 }
 
@@ -321,8 +1170,8 @@ BENCHMARK(transpose_mpi_block_benchmark,
     if (pc::world_rank != 0)
       return;
 
-    float *M_cyclic = new float[PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE];
-    float *T_cyclic = new float[PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE];
+    float *M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    float *T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
 
     constexpr auto arr1 = random_arr1();
 
@@ -355,11 +1204,74 @@ BENCHMARK(transpose_mpi_block_benchmark,
 		    pc::matTransposeMPIBlock(M_cyclic, T_cyclic, (1<<N)));
     }
 
-    delete[] M_cyclic;
-    delete[] T_cyclic;
+    bench_free(M_cyclic);
+    bench_free(T_cyclic);
     return;
 }
 
+/* Rank 0 owns the first rows of M[i][j] = i * N + j, the workers
+ * build theirs. func is the message that picks the same transpose on
+ * the workers. */
+static void transpose_mpi_alltoall(const std::string& benchmark_name,
+				   const char *func,
+				   void (*transpose)(const float *, float *,
+						     tenno::size, tenno::size,
+						     tenno::size))
+{
+    if (pc::world_rank != 0)
+      return;
+
+    float *M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    float *T_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      M_cyclic[i] = float(i);
+
+    int err;
+    char message[10] = {};
+    strcpy(message, func);
+    long unsigned int num_iterations =
+	valfuzz::get_num_iterations_benchmark() + 2;
+    long unsigned int size;
+    for (size_t N = 4; N <= 12; ++N)
+    {
+      /* Message the workers */
+      err = MPI_Bcast(&message, 10, MPI_CHAR, 0, MPI_COMM_WORLD);
+      if (err != MPI_SUCCESS)
+      return;
+
+      size = (1<<N);
+      err = MPI_Bcast(&size, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      if (err != MPI_SUCCESS)
+        return;
+
+      err = MPI_Bcast(&num_iterations, 1,
+		       MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      if (err != MPI_SUCCESS)
+        return;
+
+      RUN_BENCHMARK((1<<N),
+		    transpose(M_cyclic, T_cyclic, (1<<N),
+			      PC_MATRIX_MAX_SIZE, PC_MATRIX_MAX_SIZE));
+    }
+
+    bench_free(M_cyclic);
+    bench_free(T_cyclic);
+}
+
+BENCHMARK(transpose_mpi_alltoall_benchmark,
+	  "matTransposeMPIAlltoall")
+{
+  transpose_mpi_alltoall(benchmark_name, "A2A",
+			 pc::matTransposeMPIAlltoall);
+}
+
+BENCHMARK(transpose_mpi_alltoallw_benchmark,
+	  "matTransposeMPIAlltoallw")
+{
+  transpose_mpi_alltoall(benchmark_name, "A2AW",
+			 pc::matTransposeMPIAlltoallw);
+}
+
 
 /*============================================*\
 |                   CHECK SYMM                 |
@@ -385,6 +1297,137 @@ BENCHMARK(check_sym_benchmark, "checkSymm")
     }
 }
 
+BENCHMARK(check_sym_matrix_type_benchmark, "checkSymm pc::Matrix")
+{
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      /* Symmetric, the worst case */
+      pc::Matrix M(1<<N);
+      for (auto i : tenno::range(M.rows()))
+        for (auto j : tenno::range(i, M.cols()))
+          M[i][j] = M[j][i] = float(i + j);
+      RUN_BENCHMARK((1<<N),
+		    pc::checkSym(M));
+    }
+}
+
+/* A symmetric matrix is the worst case, a random one differs in the
+ * first tile */
+static void check_sym_intrinsic(const std::string& benchmark_name,
+				bool symmetric)
+{
+    float *M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE; ++i)
+      for (size_t j = 0; j < PC_MATRIX_MAX_SIZE; ++j)
+	M_cyclic[i*PC_MATRIX_MAX_SIZE + j] =
+	  symmetric ? float(i + j)
+		    : arr1[(i*PC_MATRIX_MAX_SIZE + j) % PC_RANDOM_MATRIX_SIZE];
+
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::checkSymIntrinsic(M_cyclic, (1<<N), PC_MATRIX_MAX_SIZE));
+    }
+    bench_free(M_cyclic);
+}
+
+BENCHMARK(check_sym_intrinsic_benchmark, "checkSymIntrinsic")
+{
+  check_sym_intrinsic(benchmark_name, true);
+}
+
+BENCHMARK(check_sym_intrinsic_random_benchmark, "checkSymIntrinsic random")
+{
+  check_sym_intrinsic(benchmark_name, false);
+}
+
+BENCHMARK(check_sym_signature_benchmark, "checkSymSignature")
+{
+    /* Symmetric, so the verification would always run: without it
+     * this is the cost of the sweep alone */
+    float *M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE; ++i)
+      for (size_t j = 0; j < PC_MATRIX_MAX_SIZE; ++j)
+	M_cyclic[i*PC_MATRIX_MAX_SIZE + j] = float(i + j);
+
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::checkSymSignature(M_cyclic, (1<<N), PC_MATRIX_MAX_SIZE,
+					  false));
+    }
+    bench_free(M_cyclic);
+}
+
+/* A random matrix is rejected by the first sample, a symmetric one
+ * pays the samples on top of checkSymIntrinsic */
+static void check_sym_sampled(const std::string& benchmark_name,
+			      bool symmetric)
+{
+    float *M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE; ++i)
+      for (size_t j = 0; j < PC_MATRIX_MAX_SIZE; ++j)
+	M_cyclic[i*PC_MATRIX_MAX_SIZE + j] =
+	  symmetric ? float(i + j)
+		    : arr1[(i*PC_MATRIX_MAX_SIZE + j) % PC_RANDOM_MATRIX_SIZE];
+
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::checkSymSampled(M_cyclic, (1<<N), PC_MATRIX_MAX_SIZE));
+    }
+    bench_free(M_cyclic);
+}
+
+BENCHMARK(check_sym_sampled_benchmark, "checkSymSampled")
+{
+  check_sym_sampled(benchmark_name, true);
+}
+
+BENCHMARK(check_sym_sampled_random_benchmark, "checkSymSampled random")
+{
+  check_sym_sampled(benchmark_name, false);
+}
+
+BENCHMARK(check_sym_random_benchmark, "checkSymm random")
+{
+    float *M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+
+    constexpr auto arr1 = random_arr1();
+
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE; ++i)
+      M_cyclic[i] = arr1[i % PC_RANDOM_MATRIX_SIZE];
+
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      RUN_BENCHMARK((1<<N),
+		    pc::checkSym(M_cyclic, (1<<N), PC_MATRIX_MAX_SIZE));
+    }
+    bench_free(M_cyclic);
+}
+
+BENCHMARK(check_sym_fixed_benchmark, "checkSymFixed")
+{
+    float *M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    for (size_t N = 2; N <= 12; ++N)
+    {
+      /* Symmetric, the worst case */
+      const size_t n = 1<<N;
+      for (size_t i = 0; i < n; ++i)
+        for (size_t j = i; j < n; ++j)
+          M_cyclic[i*n + j] = M_cyclic[j*n + i] = float(i + j);
+      RUN_BENCHMARK((1<<N),
+		    pc::checkSymFixed(M_cyclic, (1<<N)));
+    }
+    bench_free(M_cyclic);
+}
+
 BENCHMARK(check_sym_columns_benchmark,
 	  "checkSymmColumns")
 {
@@ -402,7 +1445,7 @@ BENCHMARK(check_sum_MPI_benchmark,
     if (pc::world_rank != 0)
       return;
 
-    float *M_cyclic = new float[PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE];
+    float *M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
 
     constexpr auto arr1 = random_arr1();
 
@@ -439,6 +1482,105 @@ BENCHMARK(check_sum_MPI_benchmark,
 		    pc::checkSymMPI(M_cyclic, (1<<N)));
     }
 
-    delete[] M_cyclic;
+    bench_free(M_cyclic);
+    return;
+}
+
+BENCHMARK(check_sym_MPI_signature_benchmark,
+	  "checkSymMPISignature")
+{
+    if (pc::world_rank != 0)
+      return;
+
+    /* Our rows of M[i][j] = i + j, the workers build theirs */
+    float *M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE; ++i)
+      for (size_t j = 0; j < PC_MATRIX_MAX_SIZE; ++j)
+	M_cyclic[(i*PC_MATRIX_MAX_SIZE) + j] = float(i + j);
+
+    int err;
+    char message[10] = "SymSig\0";
+    long unsigned int num_iterations =
+	valfuzz::get_num_iterations_benchmark() + 2;
+    long unsigned int size;
+    for (size_t N = 4; N <= 12; ++N)
+    {
+      /* Message the workers */
+      err = MPI_Bcast(&message, 10, MPI_CHAR, 0, MPI_COMM_WORLD);
+      if (err != MPI_SUCCESS)
+      return;
+
+      size = (1<<N);
+      err = MPI_Bcast(&size, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      if (err != MPI_SUCCESS)
+        return;
+
+      err = MPI_Bcast(&num_iterations, 1,
+		       MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      if (err != MPI_SUCCESS)
+        return;
+
+      RUN_BENCHMARK((1<<N),
+		    pc::checkSymMPISignature(M_cyclic, (1<<N),
+					     PC_MATRIX_MAX_SIZE));
+    }
+
+    bench_free(M_cyclic);
     return;
 }
+
+/* Rank 0 owns the top left block of M[i][j] = i * j + i + j, a
+ * submatrix of the full buffer; the workers build theirs */
+static void check_sym_MPI_blocks(const std::string& benchmark_name,
+				 const char *func, tenno::size chunk)
+{
+    if (pc::world_rank != 0)
+      return;
+
+    float *M_cyclic = bench_alloc(PC_MATRIX_MAX_SIZE*PC_MATRIX_MAX_SIZE);
+    for (size_t i = 0; i < PC_MATRIX_MAX_SIZE; ++i)
+      for (size_t j = 0; j < PC_MATRIX_MAX_SIZE; ++j)
+	M_cyclic[(i*PC_MATRIX_MAX_SIZE) + j] = float(i * j + i + j);
+
+    int err;
+    char message[10] = {};
+    strcpy(message, func);
+    long unsigned int num_iterations =
+	valfuzz::get_num_iterations_benchmark() + 2;
+    long unsigned int size;
+    for (size_t N = 4; N <= 12; ++N)
+    {
+      /* Message the workers */
+      err = MPI_Bcast(&message, 10, MPI_CHAR, 0, MPI_COMM_WORLD);
+      if (err != MPI_SUCCESS)
+      return;
+
+      size = (1<<N);
+      err = MPI_Bcast(&size, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      if (err != MPI_SUCCESS)
+        return;
+
+      err = MPI_Bcast(&num_iterations, 1,
+		       MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      if (err != MPI_SUCCESS)
+        return;
+
+      RUN_BENCHMARK((1<<N),
+		    pc::checkSymMPIBlocks(M_cyclic, (1<<N),
+					  PC_MATRIX_MAX_SIZE, chunk));
+    }
+
+    bench_free(M_cyclic);
+}
+
+BENCHMARK(check_sym_MPI_blocks_benchmark,
+	  "checkSymMPIBlocks")
+{
+  check_sym_MPI_blocks(benchmark_name, "SymBlk", 0);
+}
+
+BENCHMARK(check_sym_MPI_blocks_chunked_benchmark,
+	  "checkSymMPIBlocks chunks of 64")
+{
+  check_sym_MPI_blocks(benchmark_name, "SymBlkC", 64);
+}
@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Giovanni Santini
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <tenno/types.hpp>
+
+namespace pc
+{
+
+
+/*============================================*\
+|                  HUGE PAGES                  |
+\*============================================*/
+
+constexpr tenno::size huge_page_size = 2 << 20;
+
+/*
+ * Maps bytes rounded up to 2 MiB, backed by huge pages when the
+ * system has them: first explicit ones (MAP_HUGETLB, which needs
+ * pages reserved in /proc/sys/vm/nr_hugepages), then transparent
+ * ones (madvise MADV_HUGEPAGE), else regular pages. *huge tells
+ * whether one of the first two succeeded. Returns nullptr on failure.
+ */
+void *hugeAlloc(tenno::size bytes, bool *huge = nullptr);
+void hugeFree(void *addr, tenno::size bytes);
+
+
+/*============================================*\
+|                     ARENA                    |
+\*============================================*/
+
+/*
+ * Stack allocator over a single hugeAlloc() mapping. release(p)
+ * frees p and everything allocated after it, so allocations have
+ * to be released in reverse order (or just the first one).
+ */
+class Arena
+{
+public:
+  explicit Arena(tenno::size capacity);
+  ~Arena();
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  /* nullptr when the arena is full */
+  void *allocate(tenno::size bytes, tenno::size alignment = 64);
+  void release(void *addr);
+  void reset() { used_ = 0; }
+  bool owns(const void *addr) const
+  {
+    const char *p = static_cast<const char *>(addr);
+    return p >= base_ && p < base_ + capacity_;
+  }
+
+  bool huge() const { return huge_; }
+  tenno::size capacity() const { return capacity_; }
+  tenno::size used() const { return used_; }
+
+private:
+  char *base_ = nullptr;
+  tenno::size capacity_ = 0;
+  tenno::size used_ = 0;
+  bool huge_ = false;
+};
+
+
+} // namespace pc
@@ -26,6 +26,13 @@
 
 #pragma once
 
+#include <tenno/types.hpp>
+#include <mpi.h>
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include <vector>
+
 namespace pc
 {
 
@@ -36,4 +43,183 @@ extern int world_size;
 extern matrix matrix_in;
 extern matrix matrix_out;
 
+/* Start of part k of N split into parts, the sizes differ by one at
+ * most */
+inline tenno::size mpiSplit(tenno::size N, int parts, int k)
+{
+  return N * tenno::size(k) / tenno::size(parts);
+}
+
+/* A matrix distributed by rows: rank r owns the rows
+ * [mpiRowBegin(N, r), mpiRowBegin(N, r + 1)) of the N x N matrix */
+inline tenno::size mpiRowBegin(tenno::size N, int rank)
+{
+  return mpiSplit(N, world_size, rank);
+}
+
+/* The P x Q grid of every rank used by the block kernels, from
+ * MPI_Dims_create, so P >= Q. Rank r sits at (r / Q, r % Q) and
+ * owns the rows mpiSplit(N, P, r / Q) of the columns
+ * mpiSplit(N, Q, r % Q). */
+inline void mpiGridDims(int &P, int &Q)
+{
+  int dims[2] = {0, 0};
+  MPI_Dims_create(world_size, 2, dims);
+  P = dims[0];
+  Q = dims[1];
+}
+
+/* A matrix distributed by 2D blocks: ranks [0, q * q) form a q x q
+ * grid, q = mpiGridSide(), and rank bi * q + bj owns the rows
+ * [mpiBlockBegin(N, bi), mpiBlockBegin(N, bi + 1)) of the columns
+ * [mpiBlockBegin(N, bj), mpiBlockBegin(N, bj + 1)). The other ranks
+ * own nothing. */
+inline int mpiGridSide()
+{
+  int q = 1;
+  while ((q + 1) * (q + 1) <= world_size)
+    ++q;
+  return q;
+}
+
+inline tenno::size mpiBlockBegin(tenno::size N, int b)
+{
+  return mpiSplit(N, mpiGridSide(), b);
+}
+
+/* Rows [r0, r0 + h) and columns [c0, c0 + w) of rank on the P x Q
+ * grid of mpiGridDims */
+inline void mpiGridBlock(tenno::size N, int P, int Q, int rank,
+			 tenno::size &r0, tenno::size &h,
+			 tenno::size &c0, tenno::size &w)
+{
+  r0 = mpiSplit(N, P, rank / Q);
+  h = mpiSplit(N, P, rank / Q + 1) - r0;
+  c0 = mpiSplit(N, Q, rank % Q);
+  w = mpiSplit(N, Q, rank % Q + 1) - c0;
+}
+
+/* Frees a derived datatype on every way out of a function */
+struct MpiTypeGuard
+{
+  MPI_Datatype type = MPI_DATATYPE_NULL;
+
+  MpiTypeGuard() = default;
+  MpiTypeGuard(const MpiTypeGuard &) = delete;
+  MpiTypeGuard &operator=(const MpiTypeGuard &) = delete;
+  ~MpiTypeGuard()
+  {
+    if (type != MPI_DATATYPE_NULL)
+      MPI_Type_free(&type);
+  }
+};
+
+/* rows x cols floats of a matrix with rows N floats apart, with an
+ * extent of one float so that displacements count floats */
+inline int mpiSubmatrixType(tenno::size rows, tenno::size cols,
+			    tenno::size N, MpiTypeGuard &type)
+{
+  MpiTypeGuard vector_t;
+  int err = MPI_Type_vector((int) rows, (int) cols, (int) N, MPI_FLOAT,
+			    &vector_t.type);
+  if (err != MPI_SUCCESS)
+    return err;
+  err = MPI_Type_create_resized(vector_t.type, 0, sizeof(float),
+				&type.type);
+  if (err != MPI_SUCCESS)
+    return err;
+  return MPI_Type_commit(&type.type);
+}
+
+/* The region of rank on the mpiGridBlock grid, or with mirror the
+ * cols x rows one across the diagonal */
+inline void mpiGridRegion(tenno::size N, int P, int Q, int rank, bool mirror,
+			  tenno::size &row0, tenno::size &rows,
+			  tenno::size &col0, tenno::size &cols)
+{
+  if (mirror)
+    mpiGridBlock(N, P, Q, rank, col0, cols, row0, rows);
+  else
+    mpiGridBlock(N, P, Q, rank, row0, rows, col0, cols);
+}
+
+/*
+ * Calls collective once per shape of region of the grid, at most four
+ * since the sides differ by one at most, with a submatrix type of the
+ * shape, the counts (1 for the ranks of that shape, 0 for the others)
+ * and displacements of every region in an N x N matrix, and the floats
+ * of the region of this rank. Displacements are ints, so N * N above
+ * INT_MAX is refused on every rank.
+ */
+template <typename Collective>
+inline int mpiGridShapes(tenno::size N, int P, int Q, bool mirror,
+			 Collective collective)
+{
+  if (N * N > INT_MAX)
+    return MPI_ERR_COUNT;
+
+  std::vector<tenno::size> row0(world_size), rows(world_size);
+  std::vector<tenno::size> col0(world_size), cols(world_size);
+  std::vector<std::pair<tenno::size, tenno::size>> shapes;
+  for (int r = 0; r < world_size; ++r)
+  {
+    mpiGridRegion(N, P, Q, r, mirror, row0[r], rows[r], col0[r], cols[r]);
+    const std::pair<tenno::size, tenno::size> shape(rows[r], cols[r]);
+    if (rows[r] > 0 && cols[r] > 0
+	&& std::find(shapes.begin(), shapes.end(), shape) == shapes.end())
+      shapes.push_back(shape);
+  }
+
+  std::vector<int> counts(world_size), displacements(world_size);
+  for (const auto &shape : shapes)
+  {
+    MpiTypeGuard region_t;
+    int err = mpiSubmatrixType(shape.first, shape.second, N, region_t);
+    if (err != MPI_SUCCESS)
+      return err;
+
+    for (int r = 0; r < world_size; ++r)
+    {
+      counts[r] = rows[r] == shape.first && cols[r] == shape.second;
+      displacements[r] = (int) (row0[r] * N + col0[r]);
+    }
+    const int own = counts[world_rank] ? (int) (shape.first * shape.second)
+				       : 0;
+    err = collective(region_t.type, counts.data(), displacements.data(), own);
+    if (err != MPI_SUCCESS)
+      return err;
+  }
+  return MPI_SUCCESS;
+}
+
+/* Rank 0 sends every rank its region of M straight from M, and each
+ * rank gets it contiguous in block */
+inline int mpiScatterGrid(const float *M, tenno::size N, int P, int Q,
+			  bool mirror, float *block)
+{
+  return mpiGridShapes(N, P, Q, mirror,
+		       [M, block](MPI_Datatype region_t, const int *counts,
+				  const int *displacements, int own)
+		       {
+			 return MPI_Scatterv(M, counts, displacements,
+					     region_t, block, own, MPI_FLOAT,
+					     0, MPI_COMM_WORLD);
+		       });
+}
+
+/* The reverse: every rank sends its contiguous block into its region
+ * of T on rank 0 */
+inline int mpiGatherGrid(const float *block, float *T, tenno::size N,
+			 int P, int Q, bool mirror)
+{
+  return mpiGridShapes(N, P, Q, mirror,
+		       [block, T](MPI_Datatype region_t, const int *counts,
+				  const int *displacements, int own)
+		       {
+			 return MPI_Gatherv(block, own, MPI_FLOAT, T, counts,
+					    displacements, region_t, 0,
+					    MPI_COMM_WORLD);
+		       });
+}
+
 } // namespace pc
@@ -26,6 +26,9 @@
 
 #pragma once
 
+#include <pc/benchmarks.hpp>
+#include <pc/matrix.hpp>
+#include <pc/omp.hpp>
 #include <tenno/types.hpp>
 
 namespace pc
@@ -38,12 +41,124 @@ namespace pc
 
 bool checkSym(float **M, tenno::size N);
 bool checkSymColumns(float **M, tenno::size N);
+/* false if M is not square */
+bool checkSym(const Matrix &M);
+bool checkSymColumns(const Matrix &M);
+/* Flat N x N matrix with rows ld floats apart, false if ld < N */
+bool checkSym(const float *M, tenno::size N, tenno::size ld);
+bool checkSymColumns(const float *M, tenno::size N, tenno::size ld);
+
+
+/*============================================*\
+|                  INTRINSIC                   |
+\*============================================*/
+
+/*
+ * Compares each tile of the upper triangle with its mirror tile,
+ * transposed in registers at the dispatched SIMD width, and returns
+ * at the first tile that differs. Same result as checkSym.
+ */
+bool checkSymIntrinsic(float **M, tenno::size N);
+bool checkSymIntrinsic(const float *M, tenno::size N, tenno::size ld);
+bool checkSymIntrinsic(const Matrix &M);
+
+
+/*============================================*\
+|                  SIGNATURE                   |
+\*============================================*/
+
+/*
+ * Hashes every row and every column in a single row major sweep with
+ * unit stride reads, and returns false if row i and column i hash
+ * differently for some i. Matching hashes are confirmed with
+ * checkSymIntrinsic, unless verify is false: then a true answer may
+ * be a hash collision, or a NaN compared with itself.
+ */
+bool checkSymSignature(float **M, tenno::size N, bool verify = true);
+bool checkSymSignature(const float *M, tenno::size N, tenno::size ld,
+		       bool verify = true);
+bool checkSymSignature(const Matrix &M, bool verify = true);
+
+
+/*============================================*\
+|                  FIXED SIZE                  |
+\*============================================*/
+
+/* Flat N x N check with N known at compile time, comparing tiles
+ * transposed in registers. Instantiated for N = 4, 8, 16, 32, 64;
+ * the runtime version falls back to checkSym for other sizes. */
+template <tenno::size N>
+bool checkSymFixed(const float *M);
+bool checkSymFixed(const float *M, tenno::size N);
+
+
+/*============================================*\
+|                     OMP                      |
+\*============================================*/
+
+/*
+ * checkSymIntrinsic shared by the OMP team. The upper triangle is
+ * cut into 64x64 blocks, one iteration each, so a static schedule is
+ * already balanced; opts.collapse has no effect. The threads stop
+ * taking blocks once one of them finds an asymmetry.
+ */
+bool checkSymOMP(float **M, tenno::size N, const OmpOptions &opts = {});
+bool checkSymOMP(const float *M, tenno::size N, tenno::size ld,
+		 const OmpOptions &opts = {});
+
+
+/*============================================*\
+|                   SAMPLING                   |
+\*============================================*/
+
+/*
+ * Compares about samples random (i, j) / (j, i) pairs first, a SIMD
+ * tile at a time, and returns false as soon as one differs; if none
+ * does the answer comes from checkSymIntrinsic. The pairs actually
+ * compared before that are stored in taken, so that samples can be
+ * tuned: rejecting a random matrix takes a single tile.
+ */
+bool checkSymSampled(float **M, tenno::size N, tenno::size samples = 4096,
+		     tenno::size *taken = nullptr);
+bool checkSymSampled(const float *M, tenno::size N, tenno::size ld,
+		     tenno::size samples = 4096, tenno::size *taken = nullptr);
 
 
 /*============================================*\
 |                     MPI                      |
 \*============================================*/
 
+/* Rank 0 scatters M over the mpiGridDims grid, each rank compares its
+ * block with the mirror one. Works for any number of ranks and any
+ * N with N * N up to INT_MAX, false above it; the result is valid on
+ * rank 0 */
 bool checkSymMPI(float *M, tenno::size N);
 
+/*
+ * For a matrix distributed by rows as in mpiRowBegin: each rank
+ * passes its own rows, ld floats apart. The row hashes of
+ * checkSymSignature stay local, the partial column hashes are summed
+ * with a single MPI_Reduce_scatter, so only O(N) words move. Every
+ * rank gets the result. A true answer is not verified, so it may be
+ * a hash collision; a single differing element always shows.
+ */
+bool checkSymMPISignature(const float *rows, tenno::size N, tenno::size ld);
+
+/*
+ * For a matrix distributed by 2D blocks as in mpiBlockBegin: each
+ * rank passes its own block, rows ld floats apart. Rank (i, j) swaps
+ * its block only with rank (j, i) through MPI_Sendrecv, the diagonal
+ * ranks check theirs locally, and an MPI_Allreduce with MPI_LAND
+ * gives every rank the result. With chunk > 0 the blocks are swapped
+ * chunk columns at a time with an MPI_Allreduce after each, so all
+ * ranks stop once one of them finds a mismatch; chunk has to be the
+ * same on every rank.
+ * The grid is square so that the mirror of a block is a single block:
+ * the world_size - q * q ranks past it hold no block and only join
+ * the reductions, e.g. 3 of 12 ranks sit idle. Use checkSymMPI to
+ * spread the work over every rank.
+ */
+bool checkSymMPIBlocks(const float *block, tenno::size N, tenno::size ld,
+		       tenno::size chunk = 0);
+
 } // pc
@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Giovanni Santini
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <tenno/types.hpp>
+
+namespace pc
+{
+
+
+/*============================================*\
+|                    PITCH                     |
+\*============================================*/
+
+/*
+ * Floats between the rows of a matrix with cols columns chosen by
+ * the library: cols rounded up to an odd number of cache lines.
+ * With a power of two pitch a column walk maps to a few cache sets
+ * only (and 4K aliases), an odd number of lines spreads it over all
+ * of them. Pass it as the leading dimension of the flat kernels.
+ */
+tenno::size paddedPitch(tenno::size cols);
+
+enum class Padding
+{
+  None, /* cols rounded up to a cache line */
+  Auto, /* paddedPitch(cols)               */
+};
+
+
+/*============================================*\
+|                    MATRIX                    |
+\*============================================*/
+
+/*
+ * Owning rows x cols matrix of floats in a single allocation.
+ * Rows are pitch() floats apart, pitch() being a multiple of 16
+ * chosen by padding, and the allocation is 64 byte aligned, so every
+ * row starts on a cache line and on an AVX-512 vector.
+ * M[i] is a view of the i-th row, so M[i][j] works as with
+ * pc::matrix; the padding after each row is never read.
+ */
+class Matrix
+{
+public:
+  static constexpr tenno::size alignment = 64;
+
+  Matrix() = default;
+  Matrix(tenno::size rows, tenno::size cols,
+	 Padding padding = Padding::None);
+  explicit Matrix(tenno::size N, Padding padding = Padding::None)
+    : Matrix(N, N, padding) {}
+  ~Matrix();
+
+  Matrix(const Matrix &) = delete;
+  Matrix &operator=(const Matrix &) = delete;
+  Matrix(Matrix &&other) noexcept;
+  Matrix &operator=(Matrix &&other) noexcept;
+
+  tenno::size rows() const { return rows_; }
+  tenno::size cols() const { return cols_; }
+  tenno::size pitch() const { return pitch_; }
+
+  float *data() { return data_; }
+  const float *data() const { return data_; }
+
+  float *operator[](tenno::size i) { return data_ + i * pitch_; }
+  const float *operator[](tenno::size i) const { return data_ + i * pitch_; }
+
+private:
+  float *data_ = nullptr;
+  tenno::size rows_ = 0;
+  tenno::size cols_ = 0;
+  tenno::size pitch_ = 0;
+};
+
+
+} // namespace pc
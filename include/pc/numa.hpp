@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Giovanni Santini
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <tenno/types.hpp>
+#include <sched.h>
+#include <vector>
+
+namespace pc
+{
+
+
+/*============================================*\
+|                   PLACEMENT                  |
+\*============================================*/
+
+/* Where the pages of a matrix end up on a multi-socket node */
+enum class NumaPlacement
+{
+  Naive,      /* touched by the calling thread, all on its node     */
+  Local,      /* touched in parallel with the kernels' partitioning */
+  Interleave, /* round robin over every online node with mbind      */
+};
+
+/*
+ * How the OMP transposes share a matrix with a static schedule: a
+ * thread gets a band of tiles of simdWidth(simdLevel()) rows of the
+ * input, and writes the same band of columns of the output.
+ */
+enum class NumaPartition
+{
+  Rows,    /* the input of a transpose  */
+  Columns, /* the output of a transpose */
+};
+
+/*
+ * Allocates a zeroed rows x cols matrix with mmap, so that it is
+ * page aligned and its pages are placed by the first write.
+ * threads is the team size of the kernels that will use it, 0
+ * means omp_get_max_threads(), and partition how they split it for
+ * the Local placement. Returns nullptr on failure.
+ */
+float *numaAlloc(tenno::size rows, tenno::size cols,
+		 NumaPlacement placement, int threads = 0,
+		 NumaPartition partition = NumaPartition::Rows);
+void numaFree(float *M, tenno::size rows, tenno::size cols);
+
+/*
+ * Writes zeros to M with the static tile schedule of the OMP
+ * kernels, so each thread's part lands on its node. Only effective
+ * on pages that were not touched yet; a page shared by two bands of
+ * columns goes to either thread.
+ */
+void numaFirstTouch(float *M, tenno::size rows, tenno::size cols,
+		    int threads = 0,
+		    NumaPartition partition = NumaPartition::Rows);
+
+/* Interleaves the pages of [addr, addr + bytes) over the online
+ * nodes. addr must be page aligned. Returns false on failure. */
+bool numaInterleave(void *addr, tenno::size bytes);
+
+/*
+ * Pins each thread of the OMP team to one cpu of the process
+ * affinity mask, in order, with sched_setaffinity, until it goes out
+ * of scope; then the previous masks are restored. Does nothing if the
+ * runtime already binds threads (OMP_PLACES / OMP_PROC_BIND).
+ */
+class ThreadPinScope
+{
+public:
+  explicit ThreadPinScope(int threads = 0);
+  ~ThreadPinScope();
+
+  ThreadPinScope(const ThreadPinScope &) = delete;
+  ThreadPinScope &operator=(const ThreadPinScope &) = delete;
+
+  /* Number of threads pinned */
+  int pinned() const { return pinned_; }
+
+private:
+  int threads_;
+  int pinned_;
+  std::vector<cpu_set_t> previous_;
+};
+
+
+} // namespace pc
@@ -0,0 +1,78 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Giovanni Santini
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <omp.h>
+
+namespace pc
+{
+
+
+/*============================================*\
+|                   OPTIONS                    |
+\*============================================*/
+
+enum class OmpSchedule
+{
+  Static,
+  Dynamic,
+  Guided,
+};
+
+/* How the iterations of an OMP kernel are shared, chosen at runtime */
+struct OmpOptions
+{
+  OmpSchedule schedule = OmpSchedule::Static;
+  int chunk = 0;    /* 0 lets the runtime choose     */
+  int collapse = 1; /* 1 or 2 loop levels shared     */
+  int threads = 0;  /* 0 uses omp_get_max_threads() */
+};
+
+/* Team size for opts */
+int ompThreads(const OmpOptions &opts);
+
+/*
+ * Makes opts.schedule and opts.chunk the schedule of the
+ * schedule(runtime) loops until it goes out of scope, then restores
+ * the previous one.
+ */
+class OmpScheduleScope
+{
+public:
+  explicit OmpScheduleScope(const OmpOptions &opts);
+  ~OmpScheduleScope();
+
+  OmpScheduleScope(const OmpScheduleScope &) = delete;
+  OmpScheduleScope &operator=(const OmpScheduleScope &) = delete;
+
+private:
+  omp_sched_t kind_;
+  int chunk_;
+};
+
+
+} // namespace pc
@@ -0,0 +1,187 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Giovanni Santini
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <tenno/types.hpp>
+
+/* gcc 12 warns about _mm512_undefined_ps() inside its own headers
+ * when the AVX-512 shuffles are inlined (gcc bug 105593) */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>         /* For AVX intrinsics */
+#pragma GCC diagnostic pop
+
+namespace pc
+{
+
+
+/*============================================*\
+|                   DISPATCH                   |
+\*============================================*/
+
+/* Instruction sets with a transpose kernel, narrowest first */
+enum class SimdLevel
+{
+  SSE,    /* 4x4 tiles   */
+  AVX2,   /* 8x8 tiles   */
+  AVX512, /* 16x16 tiles */
+};
+
+/*
+ * Widest level supported by the cpu running the binary, detected
+ * once with cpuid. The wider kernels are compiled with target
+ * attributes so the same binary runs on every node.
+ */
+SimdLevel simdLevel();
+
+/* Forces a narrower level, clamped to what the cpu supports.
+ * Used by tests and benchmarks to compare the kernels. */
+void setSimdLevel(SimdLevel level);
+
+/* Side of the tile transposed in registers */
+constexpr tenno::size simdWidth(SimdLevel level)
+{
+  return level == SimdLevel::AVX512 ? 16
+       : level == SimdLevel::AVX2   ? 8
+                                    : 4;
+}
+
+/* Widest level of at most level whose tile fits in N, for the
+ * kernels of a size fixed at compile time */
+constexpr SimdLevel simdFixedLevel(tenno::size N, SimdLevel level)
+{
+  return simdWidth(level) <= N ? level
+       : simdWidth(SimdLevel::AVX2) <= N ? SimdLevel::AVX2
+                                         : SimdLevel::SSE;
+}
+
+
+/*============================================*\
+|                   STREAMING                  |
+\*============================================*/
+
+/*
+ * Size in bytes of input plus output above which the cyclic
+ * intrinsic transposes write with non-temporal stores. Defaults to
+ * the size of the last level cache; 0 always streams and SIZE_MAX
+ * never does.
+ */
+tenno::size streamThreshold();
+void setStreamThreshold(tenno::size bytes);
+
+
+/*============================================*\
+|               REGISTER KERNELS               |
+\*============================================*/
+
+/* The functions below transpose a tile held in registers, r[i]
+ * being the i-th row. Callers need the same target attribute. */
+
+inline void transpose4x4_ps(__m128 r[4])
+{
+  __m128 t0 = _mm_unpacklo_ps(r[0], r[1]);
+  __m128 t1 = _mm_unpackhi_ps(r[0], r[1]);
+  __m128 t2 = _mm_unpacklo_ps(r[2], r[3]);
+  __m128 t3 = _mm_unpackhi_ps(r[2], r[3]);
+
+  r[0] = _mm_movelh_ps(t0, t2);
+  r[1] = _mm_movehl_ps(t2, t0);
+  r[2] = _mm_movelh_ps(t1, t3);
+  r[3] = _mm_movehl_ps(t3, t1);
+}
+
+__attribute__((target("avx2")))
+inline void transpose8x8_ps(__m256 r[8])
+{
+  __m256 t[8], s[8];
+
+  /* Interleave pairs of rows */
+  for (int k = 0; k < 4; ++k)
+  {
+    t[2*k]     = _mm256_unpacklo_ps(r[2*k], r[2*k + 1]);
+    t[2*k + 1] = _mm256_unpackhi_ps(r[2*k], r[2*k + 1]);
+  }
+
+  /* 4x4 transpose inside each 128 bit lane */
+  for (int k = 0; k < 2; ++k)
+  {
+    s[4*k]     = _mm256_shuffle_ps(t[4*k],     t[4*k + 2], _MM_SHUFFLE(1, 0, 1, 0));
+    s[4*k + 1] = _mm256_shuffle_ps(t[4*k],     t[4*k + 2], _MM_SHUFFLE(3, 2, 3, 2));
+    s[4*k + 2] = _mm256_shuffle_ps(t[4*k + 1], t[4*k + 3], _MM_SHUFFLE(1, 0, 1, 0));
+    s[4*k + 3] = _mm256_shuffle_ps(t[4*k + 1], t[4*k + 3], _MM_SHUFFLE(3, 2, 3, 2));
+  }
+
+  /* Swap the off diagonal 4x4 blocks */
+  for (int k = 0; k < 4; ++k)
+  {
+    r[k]     = _mm256_permute2f128_ps(s[k], s[k + 4], 0x20);
+    r[k + 4] = _mm256_permute2f128_ps(s[k], s[k + 4], 0x31);
+  }
+}
+
+__attribute__((target("avx512f")))
+inline void transpose16x16_ps(__m512 r[16])
+{
+  __m512 t[16];
+
+  /* Interleave pairs of rows */
+  for (int k = 0; k < 8; ++k)
+  {
+    t[2*k]     = _mm512_unpacklo_ps(r[2*k], r[2*k + 1]);
+    t[2*k + 1] = _mm512_unpackhi_ps(r[2*k], r[2*k + 1]);
+  }
+
+  /* 4x4 transpose inside each 128 bit lane */
+  for (int k = 0; k < 4; ++k)
+  {
+    const __m512d a = _mm512_castps_pd(t[4*k]);
+    const __m512d b = _mm512_castps_pd(t[4*k + 1]);
+    const __m512d c = _mm512_castps_pd(t[4*k + 2]);
+    const __m512d d = _mm512_castps_pd(t[4*k + 3]);
+    r[4*k]     = _mm512_castpd_ps(_mm512_unpacklo_pd(a, c));
+    r[4*k + 1] = _mm512_castpd_ps(_mm512_unpackhi_pd(a, c));
+    r[4*k + 2] = _mm512_castpd_ps(_mm512_unpacklo_pd(b, d));
+    r[4*k + 3] = _mm512_castpd_ps(_mm512_unpackhi_pd(b, d));
+  }
+
+  /* Transpose the 4x4 grid of 128 bit lanes */
+  for (int k = 0; k < 4; ++k)
+  {
+    t[k]      = _mm512_shuffle_f32x4(r[k],     r[k + 4],  0x88);
+    t[k + 4]  = _mm512_shuffle_f32x4(r[k],     r[k + 4],  0xdd);
+    t[k + 8]  = _mm512_shuffle_f32x4(r[k + 8], r[k + 12], 0x88);
+    t[k + 12] = _mm512_shuffle_f32x4(r[k + 8], r[k + 12], 0xdd);
+  }
+  for (int k = 0; k < 8; ++k)
+  {
+    r[k]     = _mm512_shuffle_f32x4(t[k], t[k + 8], 0x88);
+    r[k + 8] = _mm512_shuffle_f32x4(t[k], t[k + 8], 0xdd);
+  }
+}
+
+} // namespace pc
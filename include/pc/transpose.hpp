@@ -26,7 +26,10 @@
 
 #pragma once
 
+#include <pc/matrix.hpp>
+#include <pc/omp.hpp>
 #include <tenno/types.hpp>
+#include <complex>
 #include <omp.h>
 
 namespace pc
@@ -44,6 +47,149 @@ void matTransposeCyclic(float *M, float *T, tenno::size N);
 void matTransposeIntrinsic(float **mat_in, float **mat_out, size_t N);
 void matTransposeIntrinsicCyclic(float *mat_in, float *mat_out, size_t N);
 
+/* The cyclic kernels with rows ld floats apart instead of N, for
+ * instance paddedPitch(N). Nothing is done if ld < N. */
+void matTransposeCyclic(float *M, float *T, tenno::size N,
+			tenno::size ldm, tenno::size ldt);
+void matTransposeIntrinsicCyclic(float *mat_in, float *mat_out, size_t N,
+				 size_t ld_in, size_t ld_out);
+
+/* The same kernels on a pc::Matrix, T has to be M.cols() x M.rows()
+ * and Half and the cyclic ones need both square, otherwise nothing
+ * is done. The intrinsic one uses aligned loads and stores, the
+ * cyclic ones pass pitch() as the leading dimensions. */
+void matTranspose(const Matrix &M, Matrix &T);
+void matTransposeHalf(const Matrix &M, Matrix &T);
+void matTransposeColumns(const Matrix &M, Matrix &T);
+void matTransposeIntrinsic(const Matrix &M, Matrix &T);
+void matTransposeCyclic(const Matrix &M, Matrix &T);
+void matTransposeIntrinsicCyclic(const Matrix &M, Matrix &T);
+
+
+/*============================================*\
+|                   PREFETCH                   |
+\*============================================*/
+
+/*
+ * matTranspose and matTransposeIntrinsic with software prefetch of
+ * the data distance rows (scalar) or tiles (intrinsic) ahead. The
+ * best distance depends on the memory latency of the machine, 0
+ * disables the prefetch.
+ */
+void matTransposePrefetch(float **M, float **T, tenno::size N,
+			  tenno::size distance = 16);
+void matTransposeIntrinsicPrefetch(float **mat_in, float **mat_out, size_t N,
+				   size_t distance = 16);
+
+
+/*============================================*\
+|                   STRIDED                    |
+\*============================================*/
+
+/*
+ * B = A^T where A is rows x cols and B is cols x rows, the rows of
+ * A start lda floats apart and the rows of B ldb floats apart. Does
+ * nothing if lda < cols or ldb < rows.
+ */
+void matTransposeStrided(const float *A, tenno::size rows, tenno::size cols,
+			 tenno::size lda, float *B, tenno::size ldb);
+
+
+/*============================================*\
+|                  FIXED SIZE                  |
+\*============================================*/
+
+/*
+ * Flat N x N transpose with N known at compile time, so the tile
+ * loops are fully unrolled. Instantiated for N = 4, 8, 16, 32, 64.
+ * The runtime version uses the instance matching N, or
+ * matTransposeStrided for any other size.
+ */
+template <tenno::size N>
+void matTransposeFixed(const float *M, float *T);
+void matTransposeFixed(const float *M, float *T, tenno::size N);
+
+
+/*============================================*\
+|                ELEMENT TYPES                 |
+\*============================================*/
+
+/*
+ * matTransposeStrided for other element types, with a SIMD kernel
+ * per element size. Instantiated for the signed and unsigned 8, 16,
+ * 32 and 64 bit integers, float, double, std::complex<float> and
+ * std::complex<double>; the float overload above is preferred for
+ * float arguments.
+ */
+template <typename T>
+void matTransposeStrided(const T *A, tenno::size rows, tenno::size cols,
+			 tenno::size lda, T *B, tenno::size ldb);
+
+/* Conjugate transpose, B = A^H */
+template <typename T>
+void matTransposeConj(const std::complex<T> *A, tenno::size rows,
+		      tenno::size cols, tenno::size lda,
+		      std::complex<T> *B, tenno::size ldb);
+
+
+/*============================================*\
+|                   IN PLACE                   |
+\*============================================*/
+
+/* Square transpose without an output matrix */
+void matTransposeInPlace(float *M, tenno::size N);
+void matTransposeInPlace(float **M, tenno::size N);
+/* Row major rows x cols becomes row major cols x rows, with a row
+ * of extra floats per thread and a bit per row, or when
+ * gcd(rows, cols) >= 32 a bit per gcd(rows, cols) floats */
+void matTransposeInPlace(float *M, tenno::size rows, tenno::size cols);
+
+
+/*============================================*\
+|                CACHE OBLIVIOUS               |
+\*============================================*/
+
+/* Recursive quadrant splitting, works for any N */
+void matTransposeRecursive(float **M, float **T, tenno::size N);
+void matTransposeRecursiveCyclic(float *M, float *T, tenno::size N);
+
+
+/*============================================*\
+|                     OMP                      |
+\*============================================*/
+
+/* An iteration is an element for the cyclic kernel, a tile of the
+ * dispatched SIMD kernel for the intrinsic ones and a 64x64 block
+ * for the strided one */
+void matTransposeCyclicOMP(float *M, float *T, tenno::size N,
+			   const OmpOptions &opts = {});
+void matTransposeIntrinsicOMP(float **mat_in, float **mat_out, size_t N,
+			      const OmpOptions &opts = {});
+void matTransposeIntrinsicCyclicOMP(float *mat_in, float *mat_out, size_t N,
+				    const OmpOptions &opts = {});
+void matTransposeStridedOMP(const float *A, tenno::size rows, tenno::size cols,
+			    tenno::size lda, float *B, tenno::size ldb,
+			    const OmpOptions &opts = {});
+
+
+/*============================================*\
+|                    BATCH                     |
+\*============================================*/
+
+/*
+ * Transposes count flat N x N matrices, shared by the OMP team one
+ * matrix per iteration. The contiguous version reads matrix k at
+ * M + k * N * N and writes it at T + k * N * N, the other takes a
+ * pointer per matrix. Sizes with a matTransposeFixed instance use
+ * it; on AVX-512 8x8 matrices go in pairs, one per half of a zmm.
+ * Other multiples of 4 up to 64 use whole tiles of the widest level
+ * dividing N, the rest matTransposeStrided.
+ */
+void matTransposeBatch(const float *M, float *T, tenno::size N,
+		       tenno::size count, const OmpOptions &opts = {});
+void matTransposeBatch(const float *const *M, float *const *T, tenno::size N,
+		       tenno::size count, const OmpOptions &opts = {});
+
 
 /*============================================*\
 |                     MPI                      |
@@ -51,8 +197,30 @@ void matTransposeIntrinsicCyclic(float *mat_in, float *mat_out, size_t N);
 
 void matTransposeMPI(float *M, float *T, tenno::size N);
 void matTransposeMPINonblocking(float *M, float *T, tenno::size N);
+/* Rank 0 scatters M over the mpiGridDims grid and gathers the
+ * transposed blocks in T, for any number of ranks and any N with
+ * N * N up to INT_MAX; nothing is done above it */
 void matTransposeMPIBlock(float *M, float *T, tenno::size N);
 
+/*
+ * No root: for a matrix distributed by rows as in mpiRowBegin, each
+ * rank passes its own rows of M, ld_in floats apart, and gets the
+ * same rows of T in rows_t, ld_out floats apart. Each rank packs the
+ * columns of every other rank, swaps them with a single MPI_Alltoall
+ * (MPI_Alltoallv if N is not a multiple of the ranks) and transposes
+ * what it gets with matTransposeStrided. Nothing is done if ld_in or
+ * ld_out is below N, which has to hold on every rank, or if the rows
+ * of a rank hold more than INT_MAX floats, the largest MPI count.
+ */
+void matTransposeMPIAlltoall(const float *rows, float *rows_t, tenno::size N,
+			     tenno::size ld_in, tenno::size ld_out);
+/* Same layout, but MPI_Alltoallw transposes through the datatypes:
+ * columns of our rows are sent, contiguous rows are received, and no
+ * pack buffer is used. Which one is faster depends on the MPI
+ * implementation. */
+void matTransposeMPIAlltoallw(const float *rows, float *rows_t, tenno::size N,
+			      tenno::size ld_in, tenno::size ld_out);
+
 // Used for debugging purposes
 void matTransposeMPIBlockDebug(float *M, float *T, tenno::size N);
 
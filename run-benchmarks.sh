@@ -38,6 +38,13 @@ if [ -d $BUILD_DIR ]; then
                         --no-multithread \
                         --reporter csv \
 		: -np 1 ./build/worker
+        echo "Running regular benchmarks on huge pages..."
+        PC_HUGE_PAGES=1 mpirun -x PC_HUGE_PAGES -np 1 ./$BUILD_DIR/tests \
+                        --benchmark \
+                        --num-iterations $NUM_ITERATIONS \
+                        --no-multithread \
+                        --reporter csv \
+		: -np 1 ./build/worker
     fi
     if [ -f "$BUILD_DIR/tests_opt_o1" ]; then
         echo "Running optimized benchmarks..."
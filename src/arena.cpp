@@ -0,0 +1,94 @@
+/*============================================*\
+|                     NOTES                    |
+\*============================================*/
+/*
+ * A column walk over a 4096x4096 float matrix
+ * touches a new 4 KiB page at every element,
+ * far more than the dTLB holds. With 2 MiB
+ * pages the whole matrix needs 32 entries.
+ */
+
+#include <pc/arena.hpp>
+
+#include <sys/mman.h>
+#include <cstdint>
+
+static tenno::size round_huge(tenno::size bytes)
+{
+  return (bytes + pc::huge_page_size - 1) / pc::huge_page_size
+    * pc::huge_page_size;
+}
+
+void *pc::hugeAlloc(tenno::size bytes, bool *huge)
+{
+  const tenno::size size = round_huge(bytes);
+  if (huge != nullptr)
+    *huge = false;
+  if (size == 0)
+    return nullptr;
+
+  void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (addr != MAP_FAILED)
+  {
+    if (huge != nullptr)
+      *huge = true;
+    return addr;
+  }
+
+  /* Transparent huge pages need a 2 MiB aligned range: map one
+   * more page and unmap the unaligned head and tail */
+  const tenno::size padded = size + huge_page_size;
+  char *raw = static_cast<char *>(mmap(nullptr, padded, PROT_READ | PROT_WRITE,
+				       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (raw == MAP_FAILED)
+    return nullptr;
+
+  const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+  char *aligned = raw + (huge_page_size - start % huge_page_size) % huge_page_size;
+  const tenno::size head = (tenno::size) (aligned - raw);
+  if (head != 0)
+    munmap(raw, head);
+  if (padded - head - size != 0)
+    munmap(aligned + size, padded - head - size);
+
+  const bool advised = madvise(aligned, size, MADV_HUGEPAGE) == 0;
+  if (huge != nullptr)
+    *huge = advised;
+  return aligned;
+}
+
+void pc::hugeFree(void *addr, tenno::size bytes)
+{
+  if (addr != nullptr)
+    munmap(addr, round_huge(bytes));
+}
+
+pc::Arena::Arena(tenno::size capacity)
+  : capacity_(round_huge(capacity))
+{
+  base_ = static_cast<char *>(hugeAlloc(capacity_, &huge_));
+  if (base_ == nullptr)
+    capacity_ = 0;
+}
+
+pc::Arena::~Arena()
+{
+  hugeFree(base_, capacity_);
+}
+
+void *pc::Arena::allocate(tenno::size bytes, tenno::size alignment)
+{
+  const tenno::size start = (used_ + alignment - 1) / alignment * alignment;
+  if (base_ == nullptr || start + bytes > capacity_)
+    return nullptr;
+  used_ = start + bytes;
+  return base_ + start;
+}
+
+void pc::Arena::release(void *addr)
+{
+  char *p = static_cast<char *>(addr);
+  if (p >= base_ && p < base_ + used_)
+    used_ = (tenno::size) (p - base_);
+}
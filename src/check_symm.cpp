@@ -1,9 +1,18 @@
 #include <pc/check_symm.hpp>
+#include <pc/transpose.hpp>
 #include <pc/benchmarks.hpp>
+#include <pc/simd.hpp>
+#include <pc/omp.hpp>
 #include <mpi.h>
 #include <tenno/ranges.hpp>
 #include <immintrin.h>         /* For AVX intrinsics */
 #include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 #include <math.h>
 
 
@@ -31,171 +40,703 @@ bool pc::checkSymColumns(float **M, tenno::size N)
   return symm;
 }
 
+bool pc::checkSym(const Matrix &M)
+{
+  const tenno::size N = M.rows();
+  if (M.cols() != N)
+    return false;
+  bool symm = true;
+  for (size_t i = 0; i < N; ++i)
+    for (size_t j = i; j < N; ++j)
+      if (M[i][j] != M[j][i])
+	    symm = false;
+  return symm;
+}
+
+bool pc::checkSymColumns(const Matrix &M)
+{
+  const tenno::size N = M.rows();
+  if (M.cols() != N)
+    return false;
+  bool symm = true;
+  for (size_t i = 0; i < N; ++i)
+    for (size_t j = i; j < N; ++j)
+      if (M[j][i] != M[i][j])
+	    symm = false;
+  return symm;
+}
+
+bool pc::checkSym(const float *M, tenno::size N, tenno::size ld)
+{
+  if (ld < N)
+    return false;
+  bool symm = true;
+  for (size_t i = 0; i < N; ++i)
+    for (size_t j = i; j < N; ++j)
+      if (M[i*ld + j] != M[j*ld + i])
+	    symm = false;
+  return symm;
+}
+
+bool pc::checkSymColumns(const float *M, tenno::size N, tenno::size ld)
+{
+  if (ld < N)
+    return false;
+  bool symm = true;
+  for (size_t i = 0; i < N; ++i)
+    for (size_t j = i; j < N; ++j)
+      if (M[j*ld + i] != M[i*ld + j])
+	    symm = false;
+  return symm;
+}
+
 
 /*============================================*\
-|                     MPI                      |
+|                  TILE COMPARE                |
 \*============================================*/
 
+/*
+ * True when the W x W tile with rows a[0..W), transposed in
+ * registers, equals the tile with rows b[0..W). NEQ_UQ gives the same
+ * answer as != in checkSym: a NaN never matches.
+ */
+static bool tile_mirrors_4x4(const float *const *a, const float *const *b)
+{
+  __m128 r[4];
+  for (size_t i = 0; i < 4; ++i)
+    r[i] = _mm_loadu_ps(a[i]);
+  pc::transpose4x4_ps(r);
 
-bool pc::checkSymMPI(float *M, tenno::size N)
+  __m128 ne = _mm_setzero_ps();
+  for (size_t i = 0; i < 4; ++i)
+    ne = _mm_or_ps(ne, _mm_cmpneq_ps(r[i], _mm_loadu_ps(b[i])));
+  return _mm_movemask_ps(ne) == 0;
+}
+
+__attribute__((target("avx2")))
+static bool tile_mirrors_8x8(const float *const *a, const float *const *b)
 {
-  if (world_size > (int) (N * N) || world_size < 4) /* fallback */
+  __m256 r[8];
+  for (size_t i = 0; i < 8; ++i)
+    r[i] = _mm256_loadu_ps(a[i]);
+  pc::transpose8x8_ps(r);
+
+  __m256 ne = _mm256_setzero_ps();
+  for (size_t i = 0; i < 8; ++i)
+    ne = _mm256_or_ps(ne, _mm256_cmp_ps(r[i], _mm256_loadu_ps(b[i]),
+					_CMP_NEQ_UQ));
+  return _mm256_movemask_ps(ne) == 0;
+}
+
+__attribute__((target("avx512f")))
+static bool tile_mirrors_16x16(const float *const *a, const float *const *b)
+{
+  __m512 r[16];
+  for (size_t i = 0; i < 16; ++i)
+    r[i] = _mm512_loadu_ps(a[i]);
+  pc::transpose16x16_ps(r);
+
+  __mmask16 ne = 0;
+  for (size_t i = 0; i < 16; ++i)
+    ne |= _mm512_cmp_ps_mask(r[i], _mm512_loadu_ps(b[i]), _CMP_NEQ_UQ);
+  return ne == 0;
+}
+
+static bool tile_mirrors(const float *const *a, const float *const *b,
+			 pc::SimdLevel level)
+{
+  switch (level)
   {
-    bool symm = true;
-    if (world_rank == 0)
+  case pc::SimdLevel::AVX512:
+    return tile_mirrors_16x16(a, b);
+  case pc::SimdLevel::AVX2:
+    return tile_mirrors_8x8(a, b);
+  default:
+    return tile_mirrors_4x4(a, b);
+  }
+}
+
+/*
+ * The pairs (i, j) with j >= i of the block [i0, i1) x [j0, j1)
+ * against their mirrors, row(i) being the start of row i, returning
+ * at the first tile that differs. A block on the diagonal has
+ * i0 == j0. What is left of W x W tiles is compared one element at
+ * a time.
+ */
+template <typename Row>
+static bool check_sym_block(Row row, size_t i0, size_t i1,
+			    size_t j0, size_t j1, pc::SimdLevel level)
+{
+  const size_t W = pc::simdWidth(level);
+  const size_t ti = i1 - (i1 - i0) % W;
+  const size_t tj = j1 - (j1 - j0) % W;
+
+  const float *a[16], *b[16];
+  for (size_t i = i0; i < ti; i += W)
+    for (size_t j = (i0 == j0 ? i : j0); j < tj; j += W)
     {
-      for (size_t i = 0; i < N; ++i)
-        for (size_t j = i; j < N; ++j)
-          if (M[i*N + j] != M[j*N + i])
-	    symm = false;
+      for (size_t k = 0; k < W; ++k)
+      {
+	a[k] = row(i + k) + j;
+	b[k] = row(j + k) + i;
+      }
+      if (!tile_mirrors(a, b, level))
+	return false;
+    }
+
+  for (size_t i = i0; i < i1; ++i)
+    for (size_t j = std::max(i, tj); j < j1; ++j)
+      if (row(i)[j] != row(j)[i])
+	return false;
+  for (size_t i = ti; i < i1; ++i)
+    for (size_t j = std::max(i, j0); j < tj; ++j)
+      if (row(i)[j] != row(j)[i])
+	return false;
+  return true;
+}
+
+template <typename Row>
+static bool check_sym_tiles(Row row, size_t N, pc::SimdLevel level)
+{
+  return check_sym_block(row, 0, N, 0, N, level);
+}
+
+
+/*============================================*\
+|                  INTRINSIC                   |
+\*============================================*/
+
+bool pc::checkSymIntrinsic(float **M, tenno::size N)
+{
+  return check_sym_tiles([M](size_t i) { return M[i]; }, N, pc::simdLevel());
+}
+
+bool pc::checkSymIntrinsic(const float *M, tenno::size N, tenno::size ld)
+{
+  if (ld < N)
+    return false;
+  return check_sym_tiles([M, ld](size_t i) { return M + i * ld; }, N,
+			 pc::simdLevel());
+}
+
+bool pc::checkSymIntrinsic(const Matrix &M)
+{
+  if (M.cols() != M.rows())
+    return false;
+  return checkSymIntrinsic(M.data(), M.rows(), M.pitch());
+}
+
+
+/*============================================*\
+|                  SIGNATURE                   |
+\*============================================*/
+
+/*
+ * Row i and column i are hashed as sum_k mix(x_k) * weight(k) mod
+ * 2^32. mix is a bijection of the bits and the weights are odd, so
+ * two sequences that differ in one element always hash differently.
+ * -0 is hashed as +0, which compares equal to it; this is done on the
+ * bits since x + 0.0f does not survive -ffast-math.
+ */
+static inline uint32_t signature_mix(float x)
+{
+  uint32_t v;
+  std::memcpy(&v, &x, sizeof(v));
+  if ((v & 0x7FFFFFFFu) == 0)
+    v = 0;
+  return (v ^ (v >> 15)) * 0x2C1B3C6Du;
+}
+
+static inline uint32_t signature_weight(size_t k)
+{
+  return (uint32_t(k) * 0x9E3779B1u + 0x7F4A7C15u) | 1u;
+}
+
+/* One row major sweep over rows [i0, i1) of N columns: the hash of
+ * row i is accumulated in registers and stored in rs[i - i0], what
+ * these rows add to the column hashes in cs, both with unit stride */
+template <typename Row>
+static void signatures(Row row, size_t i0, size_t i1, size_t N,
+		       const uint32_t *w, uint32_t *rs, uint32_t *cs)
+{
+  for (size_t i = i0; i < i1; ++i)
+  {
+    const float *r = row(i);
+    uint32_t acc = 0;
+    for (size_t j = 0; j < N; ++j)
+    {
+      const uint32_t h = signature_mix(r[j]);
+      acc += h * w[j];
+      cs[j] += h * w[i];
     }
-    return symm;
+    rs[i - i0] = acc;
   }
+}
 
-  /* Calculate the displacement */
-  int block_side = (int)N/int(sqrt(world_size));
-  float *block = new float[block_side * block_side];
-  float *block_transposed = new float[block_side * block_side];
-  bool isSymm = true;
-  bool res = true;
-  int *displacements = new int[world_size];
-  int *displacements_transposed = new int[world_size];
-  int *counts = new int[world_size];
-  for (int i = 0; i < world_size; ++i)
-  { /* Displacement of block types, assuming a stride of sizeof(float) beween 2 blocks */
-    displacements[i] =
-                 ((i*block_side)%(int)N)        /* col */
-               + (i*block_side/(int)N)*(int)N*block_side; /* row    */
-    displacements_transposed[i] =
-                 ((i*block_side)%(int)N)*(int)N /* col */
-               + (i*block_side/(int)N)*block_side;       /*  row */
-    counts[i] = 1;
+template <typename Row>
+__attribute__((target("avx2")))
+static void signatures_avx2(Row row, size_t i0, size_t i1, size_t N,
+			    const uint32_t *w, uint32_t *rs, uint32_t *cs)
+{
+  const __m256i abs = _mm256_set1_epi32(0x7FFFFFFF);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i mul = _mm256_set1_epi32(0x2C1B3C6D);
+  const size_t full = N - N % 8;
+  for (size_t i = i0; i < i1; ++i)
+  {
+    const float *r = row(i);
+    const __m256i wi = _mm256_set1_epi32(int(w[i]));
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t j = 0; j < full; j += 8)
+    {
+      __m256i v = _mm256_loadu_si256((const __m256i *) (r + j));
+      v = _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(v, abs),
+						 zero), v);
+      v = _mm256_mullo_epi32(_mm256_xor_si256(v, _mm256_srli_epi32(v, 15)),
+			     mul);
+      acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(v,
+			 _mm256_loadu_si256((const __m256i *) (w + j))));
+      __m256i *c = (__m256i *) (cs + j);
+      _mm256_storeu_si256(c, _mm256_add_epi32(_mm256_loadu_si256(c),
+					      _mm256_mullo_epi32(v, wi)));
+    }
+
+    uint32_t lanes[8];
+    _mm256_storeu_si256((__m256i *) lanes, acc);
+    uint32_t sum = 0;
+    for (size_t k = 0; k < 8; ++k)
+      sum += lanes[k];
+    for (size_t j = full; j < N; ++j)
+    {
+      const uint32_t h = signature_mix(r[j]);
+      sum += h * w[j];
+      cs[j] += h * w[i];
+    }
+    rs[i - i0] = sum;
+  }
+}
+
+/* rs has i1 - i0 words, cs N words set to zero by the caller */
+template <typename Row>
+static void signature_sweep(Row row, size_t i0, size_t i1, size_t N,
+			    uint32_t *rs, uint32_t *cs)
+{
+  std::vector<uint32_t> w(N);
+  for (size_t k = 0; k < N; ++k)
+    w[k] = signature_weight(k);
+
+  if (pc::simdLevel() >= pc::SimdLevel::AVX2)
+    signatures_avx2(row, i0, i1, N, w.data(), rs, cs);
+  else
+    signatures(row, i0, i1, N, w.data(), rs, cs);
+}
+
+/* false as soon as a row and its column hash differently, those
+ * can not be equal */
+template <typename Row>
+static bool signatures_match(Row row, size_t N)
+{
+  std::vector<uint32_t> rs(N), cs(N, 0);
+  signature_sweep(row, 0, N, N, rs.data(), cs.data());
+
+  for (size_t i = 0; i < N; ++i)
+    if (rs[i] != cs[i])
+      return false;
+  return true;
+}
+
+bool pc::checkSymSignature(float **M, tenno::size N, bool verify)
+{
+  if (!signatures_match([M](size_t i) { return M[i]; }, N))
+    return false;
+  return !verify || checkSymIntrinsic(M, N);
+}
+
+bool pc::checkSymSignature(const float *M, tenno::size N, tenno::size ld,
+			   bool verify)
+{
+  if (ld < N)
+    return false;
+  if (!signatures_match([M, ld](size_t i) { return M + i * ld; }, N))
+    return false;
+  return !verify || checkSymIntrinsic(M, N, ld);
+}
+
+bool pc::checkSymSignature(const Matrix &M, bool verify)
+{
+  if (M.cols() != M.rows())
+    return false;
+  return checkSymSignature(M.data(), M.rows(), M.pitch(), verify);
+}
+
+
+/*============================================*\
+|                  FIXED SIZE                  |
+\*============================================*/
+
+/* With N and the level constant the tile loops unroll and the row
+ * pointers fold into addressing */
+template <tenno::size N, pc::SimdLevel L>
+static bool check_sym_fixed(const float *M)
+{
+  return check_sym_tiles([M](size_t i) { return M + i * N; }, N,
+			 pc::simdFixedLevel(N, L));
+}
+
+template <tenno::size N>
+bool pc::checkSymFixed(const float *M)
+{
+  static_assert(N % 4 == 0, "N has to be a multiple of the SSE tile");
+  switch (pc::simdLevel())
+  {
+  case pc::SimdLevel::AVX512:
+    return check_sym_fixed<N, pc::SimdLevel::AVX512>(M);
+  case pc::SimdLevel::AVX2:
+    return check_sym_fixed<N, pc::SimdLevel::AVX2>(M);
+  default:
+    return check_sym_fixed<N, pc::SimdLevel::SSE>(M);
   }
+}
+
+template bool pc::checkSymFixed<4>(const float *);
+template bool pc::checkSymFixed<8>(const float *);
+template bool pc::checkSymFixed<16>(const float *);
+template bool pc::checkSymFixed<32>(const float *);
+template bool pc::checkSymFixed<64>(const float *);
 
-  /* Debug */
-  /*
-  if (world_rank == 0)
+bool pc::checkSymFixed(const float *M, tenno::size N)
+{
+  switch (N)
   {
-  printf("Displacements:\n");
-  for (int i = 0; i < world_size; ++i)
-      printf("%d ", displacements[i]);
-  printf("\n");
-  for (int i = 0; i < world_size; ++i)
-      printf("%d ", displacements_transposed[i]);
-  printf("\n");
+  case 4:
+    return checkSymFixed<4>(M);
+  case 8:
+    return checkSymFixed<8>(M);
+  case 16:
+    return checkSymFixed<16>(M);
+  case 32:
+    return checkSymFixed<32>(M);
+  case 64:
+    return checkSymFixed<64>(M);
+  default:
+    return checkSym(M, N, N);
   }
-  */
+}
 
-  //printf("Lots of processes\n");
 
-  MPI_Datatype block_t_tmp, block_t;
-  int err = MPI_Type_vector(block_side, /* count       */
-                         block_side,    /* blocklength */
-			 (int)N,        /* stride      */
-			 MPI_FLOAT,     /* oldtype     */
-			 &block_t_tmp); /* newtype     */
-  if (err != MPI_SUCCESS)
+/*============================================*\
+|                     OMP                      |
+\*============================================*/
+
+#define PC_SYMM_BLOCK 64
+
+/*
+ * Block t of the upper triangle of an nb x nb grid of blocks, in row
+ * major order. Counted from the end, the rows have 1, 2, 3, ...
+ * blocks, so the row is the root of a triangular number.
+ */
+static void triangle_block(size_t t, size_t nb, size_t &bi, size_t &bj)
+{
+  const size_t r = nb * (nb + 1) / 2 - 1 - t;
+  size_t k = (size_t) ((std::sqrt(8.0 * double(r) + 1.0) - 1.0) / 2.0);
+  while ((k + 1) * (k + 2) / 2 <= r)
+    ++k;
+  while (k * (k + 1) / 2 > r)
+    --k;
+  bi = nb - 1 - k;
+  bj = nb - 1 - (r - k * (k + 1) / 2);
+}
+
+/*
+ * One iteration per block of the triangle, so that every iteration
+ * but the diagonal ones has the same work whatever the schedule. The
+ * first asymmetric block clears the flag, which makes the others
+ * skip theirs, and cancels the loop when OMP_CANCELLATION is set.
+ */
+template <typename Row>
+static bool check_sym_omp(Row row, size_t N, const pc::OmpOptions &opts)
+{
+  const pc::SimdLevel level = pc::simdLevel();
+  const size_t nb = (N + PC_SYMM_BLOCK - 1) / PC_SYMM_BLOCK;
+  const size_t blocks = nb * (nb + 1) / 2;
+  std::atomic<bool> symm(true);
+
+  pc::OmpScheduleScope scope(opts);
+  #pragma omp parallel num_threads(pc::ompThreads(opts))
   {
-    delete[] block;
-    delete[] counts;
-    delete[] displacements;
-    delete[] displacements_transposed;
+    #pragma omp for schedule(runtime)
+    for (size_t t = 0; t < blocks; ++t)
+    {
+      if (!symm.load(std::memory_order_relaxed))
+	continue;
+
+      size_t bi, bj;
+      triangle_block(t, nb, bi, bj);
+      const size_t i0 = bi * PC_SYMM_BLOCK, j0 = bj * PC_SYMM_BLOCK;
+      if (!check_sym_block(row, i0, std::min(i0 + PC_SYMM_BLOCK, N),
+			   j0, std::min(j0 + PC_SYMM_BLOCK, N), level))
+      {
+	symm.store(false, std::memory_order_relaxed);
+	#pragma omp cancel for
+      }
+      #pragma omp cancellation point for
+    }
+  }
+  return symm.load();
+}
+
+bool pc::checkSymOMP(float **M, tenno::size N, const OmpOptions &opts)
+{
+  return check_sym_omp([M](size_t i) { return M[i]; }, N, opts);
+}
+
+bool pc::checkSymOMP(const float *M, tenno::size N, tenno::size ld,
+		     const OmpOptions &opts)
+{
+  if (ld < N)
     return false;
+  return check_sym_omp([M, ld](size_t i) { return M + i * ld; }, N, opts);
+}
+
+
+/*============================================*\
+|                   SAMPLING                   |
+\*============================================*/
+
+/* splitmix64, a different sequence on every call */
+static uint64_t sample_random()
+{
+  static thread_local uint64_t state = 0x853C49E6748FEA9Bull;
+  uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+/*
+ * Compares random W x W tiles of the upper triangle with their
+ * mirrors until samples pairs are compared, a whole tile at a time
+ * so every sample costs a few cache lines. false on the first tile
+ * that differs.
+ */
+template <typename Row>
+static bool sample_tiles(Row row, size_t N, size_t samples, size_t &taken)
+{
+  const pc::SimdLevel level = pc::simdLevel();
+  const size_t W = pc::simdWidth(level);
+  const size_t nt = N / W;
+  const size_t tiles = nt * (nt + 1) / 2;
+
+  const float *a[16], *b[16];
+  taken = 0;
+  while (tiles > 0 && taken < samples)
+  {
+    size_t ti, tj;
+    triangle_block(size_t(sample_random() % tiles), nt, ti, tj);
+    for (size_t k = 0; k < W; ++k)
+    {
+      a[k] = row(ti * W + k) + tj * W;
+      b[k] = row(tj * W + k) + ti * W;
+    }
+    taken += W * W;
+    if (!tile_mirrors(a, b, level))
+      return false;
   }
-  err = MPI_Type_create_resized(block_t_tmp,     /* oldtype */
-				 0,             /* lb      */
-				 sizeof(float), /* extent  */
-				 &block_t);       /* newtype */
-  err = MPI_Type_commit(&block_t);
+  return true;
+}
+
+bool pc::checkSymSampled(float **M, tenno::size N, tenno::size samples,
+			 tenno::size *taken)
+{
+  size_t n;
+  const bool pass = sample_tiles([M](size_t i) { return M[i]; }, N,
+				 samples, n);
+  if (taken)
+    *taken = n;
+  return pass && checkSymIntrinsic(M, N);
+}
+
+bool pc::checkSymSampled(const float *M, tenno::size N, tenno::size ld,
+			 tenno::size samples, tenno::size *taken)
+{
+  if (taken)
+    *taken = 0;
+  if (ld < N)
+    return false;
+
+  size_t n;
+  const bool pass = sample_tiles([M, ld](size_t i) { return M + i * ld; },
+				 N, samples, n);
+  if (taken)
+    *taken = n;
+  return pass && checkSymIntrinsic(M, N, ld);
+}
+
+
+/*============================================*\
+|                     MPI                      |
+\*============================================*/
+
+
+bool pc::checkSymMPI(float *M, tenno::size N)
+{
+  /* Each rank gets its block of the P x Q grid and the mirror of it,
+   * scattered by rank 0 straight from M */
+  int P, Q;
+  mpiGridDims(P, Q);
+
+  size_t r0, h, c0, w;
+  pc::mpiGridBlock(N, P, Q, world_rank, r0, h, c0, w);
+  std::vector<float> block(h * w), mirror(h * w), mirror_t(h * w);
+  bool res = true;
+  if (mpiScatterGrid(M, N, P, Q, false, block.data()) != MPI_SUCCESS)
+    return false;
+  if (mpiScatterGrid(M, N, P, Q, true, mirror.data()) != MPI_SUCCESS)
+    return false;
+
+  /* The mirror is w x h */
+  bool isSymm = true;
+  matTransposeStrided(mirror.data(), w, h, h, mirror_t.data(), w);
+  for (size_t i = 0; i < h * w; ++i)
+    if (block[i] != mirror_t[i])
+      isSymm = false;
+
+  int err = MPI_Reduce(&isSymm,    /* sendbuf  */
+		       &res,       /* recvbuf  */
+		       1,          /* count    */
+		       MPI_C_BOOL,   /* datatype */
+		       MPI_LAND,    /* op       */
+		       0,          /* root     */
+		       MPI_COMM_WORLD /* comm  */);
   if (err != MPI_SUCCESS)
-  {
-    delete[] block;
-    delete[] counts;
-    delete[] displacements;
-    delete[] displacements_transposed;
     return false;
-  }
-  MPI_Type_free(&block_t_tmp);
-
-  //printf("Scattering\n");
-  
-  err = MPI_Scatterv(M,                /* sendbuf       */
-		     counts,           /* sendcount     */
-                     displacements,    /* displacements */
-		     block_t,          /* sendtype      */
-		     block,            /* recvbuf       */
-		     block_side * block_side, /* recvcount */
-		     MPI_FLOAT,        /* recvtype      */
-		     0,                /* root          */
- 		     MPI_COMM_WORLD);  /* comm          */
+  return res;
+}
+
+bool pc::checkSymMPISignature(const float *rows, tenno::size N,
+			      tenno::size ld)
+{
+  const size_t r0 = mpiRowBegin(N, world_rank);
+  const size_t r1 = mpiRowBegin(N, world_rank + 1);
+  std::vector<uint32_t> rs(r1 - r0), cs(N, 0), cs_mine(r1 - r0);
+  std::vector<int> counts(world_size);
+  for (int r = 0; r < world_size; ++r)
+    counts[r] = int(mpiRowBegin(N, r + 1) - mpiRowBegin(N, r));
+
+  /* Rows of other ranks are not there, so a short ld is only
+   * reported in the result */
+  bool symm = ld >= N;
+  if (symm)
+    signature_sweep([rows, ld, r0](size_t i) { return rows + (i - r0) * ld; },
+		    r0, r1, N, rs.data(), cs.data());
+
+  /* Sums the partial column hashes and hands each rank those of the
+   * columns with the indices of its rows */
+  int err = MPI_Reduce_scatter(cs.data(), cs_mine.data(), counts.data(),
+			       MPI_UINT32_T, MPI_SUM, MPI_COMM_WORLD);
   if (err != MPI_SUCCESS)
-    goto end;
-
-  err = MPI_Scatterv(M,                /* sendbuf       */
-		     counts,           /* sendcount     */
-                     displacements_transposed, /* displacements */
-		     block_t,          /* sendtype      */
-		     block_transposed, /* recvbuf       */
-		     block_side * block_side, /* recvcount */
-		     MPI_FLOAT,        /* recvtype      */
-		     0,                /* root          */
- 		     MPI_COMM_WORLD);  /* comm          */
+    return false;
+
+  for (size_t i = 0; symm && i < r1 - r0; ++i)
+    if (rs[i] != cs_mine[i])
+      symm = false;
+
+  bool res = false;
+  err = MPI_Allreduce(&symm, &res, 1, MPI_C_BOOL, MPI_LAND, MPI_COMM_WORLD);
   if (err != MPI_SUCCESS)
-    goto end;
+    return false;
+  return res;
+}
 
-  //printf("Scattered\n");
-  /*
-  if (pc::world_rank == 0)
-  {
-  for (size_t i = 0; i < block_side * block_side; ++i)
+/* Sends the columns [k, k + n) of the h x w block at block, rows ld
+ * floats apart, and receives the partner's into recv */
+static int swap_columns(const float *block, size_t h, size_t ld, size_t k,
+			size_t n, float *recv, size_t recv_count, int partner)
+{
+  if (recv_count > INT_MAX)
+    return MPI_ERR_COUNT;
+
+  pc::MpiTypeGuard slab_t;
+  int count = 0;
+  if (h > 0 && n > 0)
   {
-      if (i % block_side == 0 && i != 0)
-        fprintf(stdout, "\n");
-      fprintf(stdout, "%f ", block[i]);
-  }
-  printf("\n");
+    if (h > INT_MAX || n > INT_MAX || ld > INT_MAX)
+      return MPI_ERR_COUNT;
+    int err = MPI_Type_vector((int) h, (int) n, (int) ld, MPI_FLOAT,
+			      &slab_t.type);
+    if (err != MPI_SUCCESS)
+      return err;
+    err = MPI_Type_commit(&slab_t.type);
+    if (err != MPI_SUCCESS)
+      return err;
+    count = 1;
   }
-  */
 
-  /* Check the symmetry */
-  //printf("Transposed:\n");
-  for (int i = 0; i < (int) (block_side); ++i)
-    for (int j = 0; j < (int) (block_side); ++j)
-      if (block[i*block_side + j] != block_transposed[j * block_side + i])
-	isSymm = false;
+  return MPI_Sendrecv(block + k, count, count > 0 ? slab_t.type : MPI_FLOAT,
+		      partner, 0, recv, (int) recv_count, MPI_FLOAT, partner,
+		      0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+}
 
-  /*
-  if (pc::world_rank == 0)
-  {
-  fprintf(stdout, "Transposed: \n");
-  for (size_t i = 0; i < block_side * block_side; ++i)
+bool pc::checkSymMPIBlocks(const float *block, tenno::size N, tenno::size ld,
+			   tenno::size chunk)
+{
+  const int q = mpiGridSide();
+  const bool owner = world_rank < q * q;
+  const int bi = world_rank / q, bj = world_rank % q;
+  const size_t h = owner ? mpiBlockBegin(N, bi + 1) - mpiBlockBegin(N, bi) : 0;
+  const size_t w = owner ? mpiBlockBegin(N, bj + 1) - mpiBlockBegin(N, bj) : 0;
+  const int partner = bj * q + bi;
+
+  /* Every rank runs the same rounds, so they have to be counted on the
+   * widest block of the grid */
+  size_t widest = 0;
+  for (int b = 0; b < q; ++b)
+    widest = std::max(widest, mpiBlockBegin(N, b + 1) - mpiBlockBegin(N, b));
+  const size_t c = std::max<size_t>(chunk > 0 ? std::min(chunk, widest)
+					      : widest, 1);
+  const size_t rounds = (widest + c - 1) / c;
+  /* The counts are ints; these are the same on every rank, while a
+   * rank with ld too large only stops sending */
+  if (widest * c > INT_MAX)
+    return false;
+
+  bool symm = ld >= w && ld <= INT_MAX;
+  std::vector<float> theirs(c * w), mirror(c * w);
+  for (size_t round = 0; round < rounds; ++round)
   {
-      if (i % block_side == 0 && i != 0)
-        fprintf(stdout, "\n");
-      fprintf(stdout, "%f ", block[i]);
-  }
-  printf("\n");
-  }
-  */
-
-  // printf("Reducing\n");
-  err = MPI_Reduce(&isSymm,    /* sendbuf  */
-		   &res,       /* recvbuf  */
-		   1,          /* count    */
-		   MPI_C_BOOL,   /* datatype */
-		   MPI_LAND,    /* op       */
-		   0,          /* root     */
-		   MPI_COMM_WORLD /* comm  */);
-  if (err != MPI_SUCCESS)
-    goto end;
+    const size_t k = round * c;
+    if (owner && partner == world_rank)
+    {
+      if (round == 0 && symm)
+	symm = checkSymIntrinsic(block, h, ld);
+    }
+    else if (owner)
+    {
+      /* Our columns [k, k + n) mirror the partner's rows, its columns
+       * [k, k + m) mirror our rows, a w x m slab */
+      const size_t n = symm ? std::min(c, w - std::min(k, w)) : 0;
+      const size_t m = std::min(c, h - std::min(k, h));
+      if (swap_columns(block, h, ld, k, n, theirs.data(), w * m, partner)
+	  != MPI_SUCCESS)
+	return false;
 
-  //printf("Reduced\n");
+      if (symm && m > 0)
+      {
+	matTransposeStrided(theirs.data(), w, m, m, mirror.data(), w);
+	for (size_t i = 0; i < m; ++i)
+	  for (size_t j = 0; j < w; ++j)
+	    if (block[(k + i) * ld + j] != mirror[i * w + j])
+	      symm = false;
+      }
+    }
 
-end:
-  delete[] block;
-  delete[] displacements;
-  delete[] displacements_transposed;
-  delete[] counts;
-  MPI_Type_free(&block_t);
-  return res;
+    /* The early abort: everyone learns about a mismatch here */
+    bool res = false;
+    if (MPI_Allreduce(&symm, &res, 1, MPI_C_BOOL, MPI_LAND, MPI_COMM_WORLD)
+	!= MPI_SUCCESS)
+      return false;
+    if (!res)
+      return false;
+  }
+  return true;
 }
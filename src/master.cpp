@@ -96,11 +96,40 @@ int main(int argc, char** argv)
     for (unsigned long i = 0; i < num_iterations; ++i)
 	pc::matTransposeMPIBlock(mat1, mat2, N);
   }
+  else if (strcmp(func, "A2A") == 0 || strcmp(func, "A2AW") == 0)
+  {
+    /* Rank 0 owns the first rows of M[i][j] = i * N + j */
+    for (size_t i = 0; i < N*N; ++i)
+      mat1[i] = float(i);
+    auto transpose = strcmp(func, "A2AW") == 0 ? pc::matTransposeMPIAlltoallw
+				     : pc::matTransposeMPIAlltoall;
+    for (unsigned long i = 0; i < num_iterations; ++i)
+	transpose(mat1, mat2, N, N, N);
+  }
   else if (strcmp(func, "Sym") == 0)
   {
     for (unsigned long i = 0; i < num_iterations; ++i)
 	pc::checkSymMPI(mat1, N);
   }
+  else if (strcmp(func, "SymSig") == 0)
+  {
+    /* Rank 0 owns the first rows, which start the matrix */
+    for (size_t i = 0; i < N; ++i)
+      for (size_t j = 0; j < N; ++j)
+	mat1[i*N + j] = float(i + j);
+    for (unsigned long i = 0; i < num_iterations; ++i)
+	pc::checkSymMPISignature(mat1, N, N);
+  }
+  else if (strcmp(func, "SymBlk") == 0 || strcmp(func, "SymBlkC") == 0)
+  {
+    /* Rank 0 owns the top left block, as a submatrix of mat1 */
+    for (size_t i = 0; i < N; ++i)
+      for (size_t j = 0; j < N; ++j)
+	mat1[i*N + j] = float(i * j + i + j);
+    const size_t chunk = strcmp(func, "SymBlkC") == 0 ? 64 : 0;
+    for (unsigned long i = 0; i < num_iterations; ++i)
+	pc::checkSymMPIBlocks(mat1, N, N, chunk);
+  }
   else {
     fprintf(stdout, "MASTER %d: No function detected\n", pc::world_rank);
   }
@@ -0,0 +1,70 @@
+/*============================================*\
+|                     NOTES                    |
+\*============================================*/
+/*
+ * A single aligned allocation instead of one
+ * new[] per row: the rows are contiguous, the
+ * SIMD kernels can use aligned loads and
+ * stores, and freeing is a single call.
+ */
+
+#include <pc/matrix.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+static constexpr tenno::size line_floats = pc::Matrix::alignment / sizeof(float);
+
+static tenno::size round_pitch(tenno::size cols)
+{
+  return (cols + line_floats - 1) / line_floats * line_floats;
+}
+
+tenno::size pc::paddedPitch(tenno::size cols)
+{
+  const tenno::size lines = round_pitch(cols) / line_floats;
+  return (lines % 2 == 0 ? lines + 1 : lines) * line_floats;
+}
+
+pc::Matrix::Matrix(tenno::size rows, tenno::size cols, Padding padding)
+  : rows_(rows), cols_(cols),
+    pitch_(padding == Padding::Auto ? paddedPitch(cols) : round_pitch(cols))
+{
+  const tenno::size bytes = rows_ * pitch_ * sizeof(float);
+  if (bytes == 0)
+    return;
+
+  /* bytes is a multiple of the alignment, as aligned_alloc wants */
+  data_ = static_cast<float *>(std::aligned_alloc(alignment, bytes));
+  if (data_ == nullptr)
+    throw std::bad_alloc();
+  std::memset(data_, 0, bytes);
+}
+
+pc::Matrix::~Matrix()
+{
+  std::free(data_);
+}
+
+pc::Matrix::Matrix(Matrix &&other) noexcept
+  : data_(std::exchange(other.data_, nullptr)),
+    rows_(std::exchange(other.rows_, 0)),
+    cols_(std::exchange(other.cols_, 0)),
+    pitch_(std::exchange(other.pitch_, 0))
+{
+}
+
+pc::Matrix &pc::Matrix::operator=(Matrix &&other) noexcept
+{
+  if (this != &other)
+  {
+    std::free(data_);
+    data_ = std::exchange(other.data_, nullptr);
+    rows_ = std::exchange(other.rows_, 0);
+    cols_ = std::exchange(other.cols_, 0);
+    pitch_ = std::exchange(other.pitch_, 0);
+  }
+  return *this;
+}
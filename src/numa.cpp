@@ -0,0 +1,187 @@
+/*============================================*\
+|                     NOTES                    |
+\*============================================*/
+/*
+ * The nodes of the cluster have two sockets,
+ * and linux places a page on the node of the
+ * thread that writes it first. Matrices
+ * initialized by a single thread are therefore
+ * remote for half of the threads of a kernel.
+ * mbind is called through syscall to avoid a
+ * dependency on libnuma.
+ */
+
+#include <pc/numa.hpp>
+#include <pc/simd.hpp>
+
+#include <omp.h>
+#include <sched.h>
+#include <linux/mempolicy.h>  /* MPOL_INTERLEAVE */
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static int team_size(int threads)
+{
+  return threads > 0 ? threads : omp_get_max_threads();
+}
+
+static size_t alloc_bytes(tenno::size rows, tenno::size cols)
+{
+  const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+  const size_t bytes = rows * cols * sizeof(float);
+  return (bytes + page - 1) / page * page;
+}
+
+/* Parses a cpulist such as "0-1,4" as found in sysfs */
+static std::vector<unsigned long> online_nodes()
+{
+  std::vector<unsigned long> nodes;
+  std::ifstream file("/sys/devices/system/node/online");
+  std::string list;
+  if (!std::getline(file, list))
+    return {0};
+
+  size_t pos = 0;
+  while (pos < list.size())
+    {
+      size_t end = list.find(',', pos);
+      if (end == std::string::npos)
+	end = list.size();
+      const std::string range = list.substr(pos, end - pos);
+      const size_t dash = range.find('-');
+      const unsigned long first = std::stoul(range.substr(0, dash));
+      const unsigned long last = dash == std::string::npos
+	? first : std::stoul(range.substr(dash + 1));
+      for (unsigned long n = first; n <= last; ++n)
+	nodes.push_back(n);
+      pos = end + 1;
+    }
+  return nodes.empty() ? std::vector<unsigned long>{0} : nodes;
+}
+
+bool pc::numaInterleave(void *addr, tenno::size bytes)
+{
+  constexpr size_t word = 8 * sizeof(unsigned long);
+  const std::vector<unsigned long> nodes = online_nodes();
+  const unsigned long max_node = nodes.back() + 1;
+  std::vector<unsigned long> mask((max_node + word - 1) / word, 0);
+  for (unsigned long n : nodes)
+    mask[n / word] |= 1ul << (n % word);
+
+  /* the kernel expects the number of bits plus one */
+  return syscall(SYS_mbind, addr, bytes, MPOL_INTERLEAVE,
+		 mask.data(), max_node + 1, 0) == 0;
+}
+
+void pc::numaFirstTouch(float *M, tenno::size rows, tenno::size cols,
+			int threads, NumaPartition partition)
+{
+  /* The iterations of the kernels, one per band of W rows of the
+   * input; the output takes the band as columns */
+  const size_t W = simdWidth(simdLevel());
+  const size_t bands = partition == NumaPartition::Rows
+    ? (rows + W - 1) / W : (cols + W - 1) / W;
+
+  #pragma omp parallel for schedule(static) num_threads(team_size(threads))
+  for (size_t b = 0; b < bands; ++b)
+  {
+    if (partition == NumaPartition::Rows)
+    {
+      for (size_t i = b * W; i < std::min(rows, (b + 1) * W); ++i)
+	std::memset(M + i * cols, 0, cols * sizeof(float));
+    }
+    else
+    {
+      const size_t w = std::min(W, cols - b * W);
+      for (size_t i = 0; i < rows; ++i)
+	std::memset(M + i * cols + b * W, 0, w * sizeof(float));
+    }
+  }
+}
+
+float *pc::numaAlloc(tenno::size rows, tenno::size cols,
+		     NumaPlacement placement, int threads,
+		     NumaPartition partition)
+{
+  const size_t bytes = alloc_bytes(rows, cols);
+  void *addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED)
+    return nullptr;
+
+  float *M = static_cast<float *>(addr);
+  switch (placement)
+    {
+    case NumaPlacement::Local:
+      numaFirstTouch(M, rows, cols, threads, partition);
+      break;
+    case NumaPlacement::Interleave:
+      /* if the kernel has no NUMA support the pages
+       * are simply placed as in the naive case */
+      numaInterleave(addr, bytes);
+      std::memset(M, 0, rows * cols * sizeof(float));
+      break;
+    default:
+      std::memset(M, 0, rows * cols * sizeof(float));
+      break;
+    }
+  return M;
+}
+
+void pc::numaFree(float *M, tenno::size rows, tenno::size cols)
+{
+  if (M != nullptr)
+    munmap(M, alloc_bytes(rows, cols));
+}
+
+pc::ThreadPinScope::ThreadPinScope(int threads)
+  : threads_(team_size(threads)), pinned_(0)
+{
+  if (omp_get_proc_bind() != omp_proc_bind_false)
+    return;
+
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    return;
+
+  std::vector<int> cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    if (CPU_ISSET(cpu, &allowed))
+      cpus.push_back(cpu);
+  if (cpus.empty())
+    return;
+
+  previous_.resize((size_t) threads_);
+  int pinned = 0;
+  #pragma omp parallel num_threads(threads_) reduction(+:pinned)
+  {
+    const size_t t = (size_t) omp_get_thread_num();
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[t % cpus.size()], &set);
+    /* pid 0 is the calling thread */
+    if (sched_getaffinity(0, sizeof(previous_[t]), &previous_[t]) == 0
+	&& sched_setaffinity(0, sizeof(set), &set) == 0)
+      pinned = 1;
+  }
+  pinned_ = pinned;
+}
+
+pc::ThreadPinScope::~ThreadPinScope()
+{
+  if (previous_.empty())
+    return;
+
+  /* The runtime keeps the same threads for a team of the same size */
+  #pragma omp parallel num_threads(threads_)
+  {
+    const size_t t = (size_t) omp_get_thread_num();
+    sched_setaffinity(0, sizeof(previous_[t]), &previous_[t]);
+  }
+}
@@ -0,0 +1,42 @@
+/*============================================*\
+|                     NOTES                    |
+\*============================================*/
+/*
+ * The kernels use schedule(runtime) so the
+ * schedule is picked per call from OmpOptions
+ * instead of being fixed at compile time; the
+ * runtime schedule is per thread state, so it
+ * is restored after each call.
+ */
+
+#include <pc/omp.hpp>
+
+int pc::ompThreads(const OmpOptions &opts)
+{
+  return opts.threads > 0 ? opts.threads : omp_get_max_threads();
+}
+
+pc::OmpScheduleScope::OmpScheduleScope(const OmpOptions &opts)
+{
+  omp_sched_t kind;
+  switch (opts.schedule)
+  {
+  case OmpSchedule::Dynamic:
+    kind = omp_sched_dynamic;
+    break;
+  case OmpSchedule::Guided:
+    kind = omp_sched_guided;
+    break;
+  default:
+    kind = omp_sched_static;
+    break;
+  }
+
+  omp_get_schedule(&kind_, &chunk_);
+  omp_set_schedule(kind, opts.chunk);
+}
+
+pc::OmpScheduleScope::~OmpScheduleScope()
+{
+  omp_set_schedule(kind_, chunk_);
+}
@@ -0,0 +1,68 @@
+/*============================================*\
+|                     NOTES                    |
+\*============================================*/
+/*
+ * Runtime detection of the widest transpose
+ * kernel. The cluster has nodes of different
+ * generations, so the binary can not be built
+ * with -march=native for all of them.
+ * The threshold for non-temporal stores is
+ * also per node, from the size of its LLC.
+ */
+
+#include <pc/simd.hpp>
+
+#include <unistd.h>
+
+static pc::SimdLevel detect()
+{
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return pc::SimdLevel::AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return pc::SimdLevel::AVX2;
+  return pc::SimdLevel::SSE;
+}
+
+static pc::SimdLevel &current()
+{
+  static pc::SimdLevel level = detect();
+  return level;
+}
+
+pc::SimdLevel pc::simdLevel()
+{
+  return current();
+}
+
+void pc::setSimdLevel(SimdLevel level)
+{
+  static const SimdLevel supported = detect();
+  current() = level < supported ? level : supported;
+}
+
+/* glibc reads the cache sizes from cpuid, other libcs may
+ * return 0 or -1 */
+static tenno::size llc_size()
+{
+  long size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+  if (size <= 0)
+    size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+  return size > 0 ? (tenno::size) size : (tenno::size) 32 << 20;
+}
+
+static tenno::size &threshold()
+{
+  static tenno::size bytes = llc_size();
+  return bytes;
+}
+
+tenno::size pc::streamThreshold()
+{
+  return threshold();
+}
+
+void pc::setStreamThreshold(tenno::size bytes)
+{
+  threshold() = bytes;
+}
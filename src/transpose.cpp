@@ -14,10 +14,18 @@
 
 #include <pc/transpose.hpp>
 #include <pc/benchmarks.hpp>
+#include <pc/simd.hpp>
 #include <mpi.h>
 #include <tenno/ranges.hpp>
 #include <immintrin.h>         /* For AVX intrinsics */
 #include <algorithm>
+#include <climits>
+#include <complex>
+#include <cstring>
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+#include <vector>
 #include <math.h>
 #include <chrono>
 #include <iostream>
@@ -55,96 +63,1582 @@ void pc::matTransposeColumns(float **M, float **T, tenno::size N)
   return;
 }
 
+void pc::matTranspose(const Matrix &M, Matrix &T)
+{
+  if (T.rows() != M.cols() || T.cols() != M.rows())
+    return;
+  for (tenno::size i = 0; i < T.rows(); ++i)
+      for (tenno::size j = 0; j < T.cols(); ++j)
+            T[i][j] = M[j][i];
+}
+
+void pc::matTransposeHalf(const Matrix &M, Matrix &T)
+{
+  const tenno::size N = M.rows();
+  if (M.cols() != N || T.rows() != N || T.cols() != N)
+    return;
+  for (tenno::size i = 0; i < N; ++i)
+      for (tenno::size j = i; j < N; ++j)
+        {
+            T[i][j] = M[j][i];
+            T[j][i] = M[i][j];
+        }
+}
+
+void pc::matTransposeColumns(const Matrix &M, Matrix &T)
+{
+  if (T.rows() != M.cols() || T.cols() != M.rows())
+    return;
+  for (tenno::size i = 0; i < M.rows(); ++i)
+      for (tenno::size j = 0; j < M.cols(); ++j)
+            T[j][i] = M[i][j];
+}
+
 void pc::matTransposeCyclic(float *M, float *T, tenno::size N) {
     for(long unsigned int n = 0; n<N*N; ++n) {
         T[n] = M[N*(n%N) + n/N];
     }
 }
 
+void pc::matTransposeCyclic(float *M, float *T, tenno::size N,
+			    tenno::size ldm, tenno::size ldt)
+{
+  if (ldm < N || ldt < N)
+    return;
+  for (tenno::size i = 0; i < N; ++i)
+      for (tenno::size j = 0; j < N; ++j)
+            T[i*ldt + j] = M[j*ldm + i];
+}
+
+/* The cyclic kernels only read M */
+void pc::matTransposeCyclic(const Matrix &M, Matrix &T)
+{
+  const tenno::size N = M.rows();
+  if (M.cols() != N || T.rows() != N || T.cols() != N)
+    return;
+  matTransposeCyclic(const_cast<float *>(M.data()), T.data(), N,
+		     M.pitch(), T.pitch());
+}
+
+/*
+Linux strikes again arch/x86/crypto/aria-aesni-avc2-asm_64.S
+#define transpose_4x4(x0, x1, x2, x3, t1, t2)		\
+	vpunpckhdq x1, x0, t2;				\
+	vpunpckldq x1, x0, x0;				\
+							\
+	vpunpckldq x3, x2, t1;				\
+	vpunpckhdq x3, x2, x2;				\
+							\
+	vpunpckhqdq t1, x0, x1;				\
+	vpunpcklqdq t1, x0, x0;				\
+							\
+	vpunpckhqdq x2, t2, x3;				\
+	vpunpcklqdq x2, t2, x2;
+
+transpose_4x4_f32_intrinsic is the intrinsic version of the above code
+*/
+void transpose_4x4_f32_intrinsic(const float *src0,
+                                 const float *src1, 
+                                 const float *src2,
+                                 const float *src3,
+                                 float *dst0,
+                                 float *dst1,
+                                 float *dst2,
+                                 float *dst3) {
+
+    __m128 row0 = _mm_loadu_ps(src0); // Load Rows
+    __m128 row1 = _mm_loadu_ps(src1);
+    __m128 row2 = _mm_loadu_ps(src2);
+    __m128 row3 = _mm_loadu_ps(src3);
+
+    // Unpack and interleave rows
+    __m128 t0 = _mm_unpacklo_ps(row0, row1);
+    __m128 t1 = _mm_unpackhi_ps(row0, row1);
+    __m128 t2 = _mm_unpacklo_ps(row2, row3);
+    __m128 t3 = _mm_unpackhi_ps(row2, row3);
+
+    // Shuffle to form transposed rows
+    __m128 d0 = _mm_movelh_ps(t0, t2);
+    __m128 d1 = _mm_movehl_ps(t2, t0);
+    __m128 d2 = _mm_movelh_ps(t1, t3);
+    __m128 d3 = _mm_movehl_ps(t3, t1);
+
+    // Store transposed rows
+    _mm_storeu_ps(dst0, d0);
+    _mm_storeu_ps(dst1, d1);
+    _mm_storeu_ps(dst2, d2);
+    _mm_storeu_ps(dst3, d3);
+}
+
+/*
+ * Tile kernels: src[i] points to the i-th row of the input tile
+ * and dst[i] to the i-th row of the output tile. The wider ones
+ * are compiled for their instruction set only and are selected
+ * at runtime, see pc::simdLevel().
+ */
+
+/* How a full tile accesses memory. Aligned needs every src[i] and
+ * dst[i], Stream every dst[i], aligned to the width of a tile row */
+enum class TileAccess
+{
+  Unaligned,
+  Aligned,  /* aligned loads and stores            */
+  Stream,   /* non-temporal stores, skip the cache */
+};
+
+template <TileAccess A>
+static void transpose_4x4_tile(const float *const *src, float *const *dst)
+{
+  if constexpr (A == TileAccess::Unaligned)
+    transpose_4x4_f32_intrinsic(src[0], src[1], src[2], src[3],
+				dst[0], dst[1], dst[2], dst[3]);
+  else
+  {
+    __m128 r[4];
+    for (int i = 0; i < 4; ++i)
+      if constexpr (A == TileAccess::Aligned)
+	r[i] = _mm_load_ps(src[i]);
+      else
+	r[i] = _mm_loadu_ps(src[i]);
+    pc::transpose4x4_ps(r);
+    for (int i = 0; i < 4; ++i)
+      if constexpr (A == TileAccess::Aligned)
+	_mm_store_ps(dst[i], r[i]);
+      else
+	_mm_stream_ps(dst[i], r[i]);
+  }
+}
+
+template <TileAccess A>
+__attribute__((target("avx2")))
+static void transpose_8x8_tile(const float *const *src, float *const *dst)
+{
+  __m256 r[8];
+  for (int i = 0; i < 8; ++i)
+    if constexpr (A == TileAccess::Aligned)
+      r[i] = _mm256_load_ps(src[i]);
+    else
+      r[i] = _mm256_loadu_ps(src[i]);
+  pc::transpose8x8_ps(r);
+  for (int i = 0; i < 8; ++i)
+    if constexpr (A == TileAccess::Stream)
+      _mm256_stream_ps(dst[i], r[i]);
+    else if constexpr (A == TileAccess::Aligned)
+      _mm256_store_ps(dst[i], r[i]);
+    else
+      _mm256_storeu_ps(dst[i], r[i]);
+}
+
+/* Edge tile with h rows of w elements, the missing rows are
+ * zeroes and never touch memory */
+__attribute__((target("avx2")))
+static void transpose_8x8_tile_masked(const float *const *src,
+				      float *const *dst,
+				      size_t h, size_t w)
+{
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i load_mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int) w), lanes);
+  const __m256i store_mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int) h), lanes);
+
+  __m256 r[8];
+  for (size_t i = 0; i < 8; ++i)
+    r[i] = i < h ? _mm256_maskload_ps(src[i], load_mask) : _mm256_setzero_ps();
+  pc::transpose8x8_ps(r);
+  for (size_t i = 0; i < w; ++i)
+    _mm256_maskstore_ps(dst[i], store_mask, r[i]);
+}
+
+template <TileAccess A>
+__attribute__((target("avx512f")))
+static void transpose_16x16_tile(const float *const *src, float *const *dst)
+{
+  __m512 r[16];
+  for (int i = 0; i < 16; ++i)
+    if constexpr (A == TileAccess::Aligned)
+      r[i] = _mm512_load_ps(src[i]);
+    else
+      r[i] = _mm512_loadu_ps(src[i]);
+  pc::transpose16x16_ps(r);
+  for (int i = 0; i < 16; ++i)
+    if constexpr (A == TileAccess::Stream)
+      _mm512_stream_ps(dst[i], r[i]);
+    else if constexpr (A == TileAccess::Aligned)
+      _mm512_store_ps(dst[i], r[i]);
+    else
+      _mm512_storeu_ps(dst[i], r[i]);
+}
+
+__attribute__((target("avx512f")))
+static void transpose_16x16_tile_masked(const float *const *src,
+					float *const *dst,
+					size_t h, size_t w)
+{
+  const __mmask16 load_mask = (__mmask16) ((1u << w) - 1);
+  const __mmask16 store_mask = (__mmask16) ((1u << h) - 1);
+
+  __m512 r[16];
+  for (size_t i = 0; i < 16; ++i)
+    r[i] = i < h ? _mm512_maskz_loadu_ps(load_mask, src[i]) : _mm512_setzero_ps();
+  pc::transpose16x16_ps(r);
+  for (size_t i = 0; i < w; ++i)
+    _mm512_mask_storeu_ps(dst[i], store_mask, r[i]);
+}
+
+template <TileAccess A>
+static void transpose_full_tile(const float *const *s, float *const *d,
+				pc::SimdLevel level)
+{
+  switch (level)
+  {
+  case pc::SimdLevel::AVX512:
+    transpose_16x16_tile<A>(s, d);
+    break;
+  case pc::SimdLevel::AVX2:
+    transpose_8x8_tile<A>(s, d);
+    break;
+  case pc::SimdLevel::SSE:
+    transpose_4x4_tile<A>(s, d);
+    break;
+  }
+}
+
+/*
+ * Transposes a tile of h rows and w columns with the kernel of the
+ * given level: full tiles with plain loads and stores, edge tiles
+ * (h, w < W) with masked ones on AVX and element by element on SSE,
+ * which has no float masks. The vector kernels read the whole tile
+ * before storing it, so src and dst may be the same tile. access
+ * only applies to full tiles; with Stream the caller has to issue
+ * the sfence.
+ */
+static void transpose_tile(const float *const *s, float *const *d,
+			   size_t h, size_t w, pc::SimdLevel level,
+			   TileAccess access = TileAccess::Unaligned)
+{
+  const size_t W = pc::simdWidth(level);
+  if (h == W && w == W)
+  {
+    switch (access)
+    {
+    case TileAccess::Aligned:
+      transpose_full_tile<TileAccess::Aligned>(s, d, level);
+      break;
+    case TileAccess::Stream:
+      transpose_full_tile<TileAccess::Stream>(s, d, level);
+      break;
+    case TileAccess::Unaligned:
+      transpose_full_tile<TileAccess::Unaligned>(s, d, level);
+      break;
+    }
+    return;
+  }
+
+  switch (level)
+  {
+  case pc::SimdLevel::AVX512:
+    transpose_16x16_tile_masked(s, d, h, w);
+    break;
+  case pc::SimdLevel::AVX2:
+    transpose_8x8_tile_masked(s, d, h, w);
+    break;
+  case pc::SimdLevel::SSE:
+    for (size_t a = 0; a < h; ++a)
+      for (size_t b = 0; b < w; ++b)
+	d[b][a] = s[a][b];
+    break;
+  }
+}
+
+/*
+ * Transposes the sub-matrix [r0,r1)x[c0,c1) one tile at a time.
+ * src(i) and dst(i) return a pointer to the i-th row of the input
+ * and output matrix, so the same code works with both layouts.
+ * A non zero prefetch brings in the tile that many tiles ahead.
+ */
+template <typename Src, typename Dst>
+static void transpose_tiles(Src src, Dst dst,
+			    size_t r0, size_t r1,
+			    size_t c0, size_t c1,
+			    pc::SimdLevel level,
+			    TileAccess access = TileAccess::Unaligned,
+			    size_t prefetch = 0)
+{
+  const size_t W = pc::simdWidth(level);
+
+  const float *row[16];
+  const float *s[16];
+  float *d[16];
+  for (size_t i = r0; i < r1; i += W)
+  {
+    const size_t h = std::min(W, r1 - i);
+    for (size_t k = 0; k < h; ++k)
+      row[k] = src(i + k);
+
+    for (size_t j = c0; j < c1; j += W)
+    {
+      const size_t w = std::min(W, c1 - j);
+      for (size_t k = 0; k < h; ++k)
+	s[k] = row[k] + j;
+      for (size_t k = 0; k < w; ++k)
+	d[k] = dst(j + k) + i;
+
+      /* The source rows are read in order, the destination lines
+       * are one row apart and get no help from the hardware */
+      const size_t ahead = j + prefetch * W;
+      if (prefetch != 0 && ahead < c1)
+      {
+	for (size_t k = 0; k < h; ++k)
+	  _mm_prefetch((const char *) (row[k] + ahead), _MM_HINT_T0);
+	for (size_t k = ahead; k < std::min(ahead + W, c1); ++k)
+	  _mm_prefetch((const char *) (dst(k) + i), _MM_HINT_T0);
+      }
+      transpose_tile(s, d, h, w, level, access);
+    }
+  }
+}
+
+/*
+ * A N x N cyclic transpose into mat_out, with rows ld_out floats
+ * apart, uses non-temporal stores when the two matrices do not fit
+ * in the last level cache, so the destination lines would only be
+ * read for ownership and evicted, and every row of every tile is
+ * aligned.
+ */
+static TileAccess cyclic_access(const float *mat_out, size_t N,
+				size_t ld_out, pc::SimdLevel level)
+{
+  const size_t W = pc::simdWidth(level);
+  const bool stream = 2 * N * N * sizeof(float) > pc::streamThreshold()
+    && ld_out % W == 0
+    && reinterpret_cast<uintptr_t>(mat_out) % (W * sizeof(float)) == 0;
+  return stream ? TileAccess::Stream : TileAccess::Unaligned;
+}
+
+void pc::matTransposeIntrinsicCyclic(float *mat_in, float *mat_out, size_t N)
+{
+  pc::matTransposeIntrinsicCyclic(mat_in, mat_out, N, N, N);
+}
+
+void pc::matTransposeIntrinsicCyclic(float *mat_in, float *mat_out, size_t N,
+				     size_t ld_in, size_t ld_out)
+{
+  if (ld_in < N || ld_out < N)
+    return;
+
+  const pc::SimdLevel level = pc::simdLevel();
+  const TileAccess access = cyclic_access(mat_out, N, ld_out, level);
+  transpose_tiles([mat_in, ld_in](size_t i) { return mat_in + i * ld_in; },
+		  [mat_out, ld_out](size_t i) { return mat_out + i * ld_out; },
+		  0, N, 0, N, level, access);
+  if (access == TileAccess::Stream)
+    _mm_sfence();
+}
+
+void pc::matTransposeIntrinsic(float **mat_in, float **mat_out, size_t N)
+{
+  transpose_tiles([mat_in](size_t i) { return mat_in[i]; },
+		  [mat_out](size_t i) { return mat_out[i]; },
+		  0, N, 0, N, pc::simdLevel());
+}
+
+void pc::matTransposeIntrinsicCyclic(const Matrix &M, Matrix &T)
+{
+  const tenno::size N = M.rows();
+  if (M.cols() != N || T.rows() != N || T.cols() != N)
+    return;
+  matTransposeIntrinsicCyclic(const_cast<float *>(M.data()), T.data(), N,
+			      M.pitch(), T.pitch());
+}
+
+/* Every tile row starts at a multiple of the tile side from an
+ * aligned row, so full tiles are always aligned */
+void pc::matTransposeIntrinsic(const Matrix &M, Matrix &T)
+{
+  if (T.rows() != M.cols() || T.cols() != M.rows())
+    return;
+
+  const pc::SimdLevel level = pc::simdLevel();
+  const TileAccess access =
+    2 * M.rows() * M.cols() * sizeof(float) > pc::streamThreshold()
+    ? TileAccess::Stream : TileAccess::Aligned;
+  transpose_tiles([&M](size_t i) { return M[i]; },
+		  [&T](size_t i) { return T[i]; },
+		  0, M.rows(), 0, M.cols(), level, access);
+  if (access == TileAccess::Stream)
+    _mm_sfence();
+}
+
+
+/*============================================*\
+|                   PREFETCH                   |
+\*============================================*/
+
+void pc::matTransposePrefetch(float **M, float **T, tenno::size N,
+			      tenno::size distance)
+{
+  for (tenno::size i = 0; i < N; ++i)
+      for (tenno::size j = 0; j < N; ++j)
+        {
+	    /* Each M[j][i] is on a different line */
+	    if (distance != 0 && j + distance < N)
+	      _mm_prefetch((const char *) (M[j + distance] + i), _MM_HINT_T0);
+            T[i][j] = M[j][i];
+        }
+}
+
+void pc::matTransposeIntrinsicPrefetch(float **mat_in, float **mat_out,
+				       size_t N, size_t distance)
+{
+  transpose_tiles([mat_in](size_t i) { return mat_in[i]; },
+		  [mat_out](size_t i) { return mat_out[i]; },
+		  0, N, 0, N, pc::simdLevel(), TileAccess::Unaligned, distance);
+}
+
+
+/*============================================*\
+|                   STRIDED                    |
+\*============================================*/
+
+/* Side of the blocks walked by the strided transpose, a block of
+ * the input and one of the output fit together in L1 */
+#define PC_TRANSPOSE_BLOCK 64
+
+/*
+ * Walks the matrix in blocks so the lines of the output written by
+ * a row of tiles are still cached when the next row of tiles of the
+ * same block reaches them, then transposes each block by tiles.
+ */
+template <typename Src, typename Dst>
+static void transpose_blocked(Src src, Dst dst, size_t rows, size_t cols,
+			      pc::SimdLevel level)
+{
+  for (size_t i = 0; i < rows; i += PC_TRANSPOSE_BLOCK)
+    for (size_t j = 0; j < cols; j += PC_TRANSPOSE_BLOCK)
+      transpose_tiles(src, dst,
+		      i, std::min(i + PC_TRANSPOSE_BLOCK, rows),
+		      j, std::min(j + PC_TRANSPOSE_BLOCK, cols),
+		      level);
+}
+
+void pc::matTransposeStrided(const float *A, tenno::size rows,
+			     tenno::size cols, tenno::size lda,
+			     float *B, tenno::size ldb)
+{
+  if (lda < cols || ldb < rows) /* rows would overlap */
+    return;
+
+  transpose_blocked([A, lda](size_t i) { return A + i * lda; },
+		    [B, ldb](size_t i) { return B + i * ldb; },
+		    rows, cols, pc::simdLevel());
+}
+
+
+/*============================================*\
+|                  FIXED SIZE                  |
+\*============================================*/
+
+/* N and the level being constants, the tile loops unroll and the
+ * pointer arrays fold into addressing */
+template <tenno::size N, pc::SimdLevel L>
+static void transpose_fixed(const float *M, float *T)
+{
+  constexpr pc::SimdLevel K = pc::simdFixedLevel(N, L);
+  constexpr size_t W = pc::simdWidth(K);
+
+  const float *s[W];
+  float *d[W];
+  for (size_t i = 0; i < N; i += W)
+    for (size_t j = 0; j < N; j += W)
+    {
+      for (size_t k = 0; k < W; ++k)
+      {
+	s[k] = M + (i + k) * N + j;
+	d[k] = T + (j + k) * N + i;
+      }
+      transpose_full_tile<TileAccess::Unaligned>(s, d, K);
+    }
+}
+
+/* A flat 4x4 matrix is one zmm or two ymm, so a permutation of the
+ * whole register transposes it with every lane in use */
+__attribute__((target("avx512f")))
+static void transpose_4x4_flat_avx512(const float *M, float *T)
+{
+  const __m512i idx = _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13,
+					2, 6, 10, 14, 3, 7, 11, 15);
+  _mm512_storeu_ps(T, _mm512_permutexvar_ps(idx, _mm512_loadu_ps(M)));
+}
+
+__attribute__((target("avx2")))
+static void transpose_4x4_flat_avx2(const float *M, float *T)
+{
+  /* unpack gives rows {0,2} and {1,3} interleaved per lane */
+  const __m256i idx = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  const __m256 x = _mm256_loadu_ps(M);
+  const __m256 y = _mm256_loadu_ps(M + 8);
+  _mm256_storeu_ps(T, _mm256_permutevar8x32_ps(_mm256_unpacklo_ps(x, y), idx));
+  _mm256_storeu_ps(T + 8,
+		   _mm256_permutevar8x32_ps(_mm256_unpackhi_ps(x, y), idx));
+}
+
+using FixedKernel = void (*)(const float *, float *);
+
+template <tenno::size N>
+static FixedKernel fixed_kernel(pc::SimdLevel level)
+{
+  static_assert(N % 4 == 0, "N has to be a multiple of the SSE tile");
+  switch (level)
+  {
+  case pc::SimdLevel::AVX512:
+    if constexpr (N == 4)
+      return transpose_4x4_flat_avx512;
+    else
+      return transpose_fixed<N, pc::SimdLevel::AVX512>;
+  case pc::SimdLevel::AVX2:
+    if constexpr (N == 4)
+      return transpose_4x4_flat_avx2;
+    else
+      return transpose_fixed<N, pc::SimdLevel::AVX2>;
+  default:
+    return transpose_fixed<N, pc::SimdLevel::SSE>;
+  }
+}
+
+/* nullptr when there is no instance for N */
+static FixedKernel fixed_kernel(tenno::size N, pc::SimdLevel level)
+{
+  switch (N)
+  {
+  case 4:
+    return fixed_kernel<4>(level);
+  case 8:
+    return fixed_kernel<8>(level);
+  case 16:
+    return fixed_kernel<16>(level);
+  case 32:
+    return fixed_kernel<32>(level);
+  case 64:
+    return fixed_kernel<64>(level);
+  default:
+    return nullptr;
+  }
+}
+
+template <tenno::size N>
+void pc::matTransposeFixed(const float *M, float *T)
+{
+  fixed_kernel<N>(pc::simdLevel())(M, T);
+}
+
+template void pc::matTransposeFixed<4>(const float *, float *);
+template void pc::matTransposeFixed<8>(const float *, float *);
+template void pc::matTransposeFixed<16>(const float *, float *);
+template void pc::matTransposeFixed<32>(const float *, float *);
+template void pc::matTransposeFixed<64>(const float *, float *);
+
+void pc::matTransposeFixed(const float *M, float *T, tenno::size N)
+{
+  const FixedKernel kernel = fixed_kernel(N, pc::simdLevel());
+  if (kernel)
+    kernel(M, T);
+  else
+    matTransposeStrided(M, N, N, N, T, N);
+}
+
+
+/*============================================*\
+|                ELEMENT TYPES                 |
+\*============================================*/
+
+/*
+ * A transpose only moves bits, so the kernels below work on lanes
+ * of the element size whatever the type: 1 byte 16x16 and 2 bytes
+ * 8x8 with SSE2 unpacks, 4 bytes the float kernels, 8 and 16 bytes
+ * the widest kernel of the level. With Conj they flip the sign bit
+ * of the upper half of each element, which is the imaginary part of
+ * a std::complex.
+ */
+using tile_kernel = void (*)(const void *const *src, void *const *dst);
+
+/* The unpack networks leave column i in register bit_reverse(i) */
+static constexpr int bit_reverse(int i, int bits)
+{
+  int r = 0;
+  for (int b = 0; b < bits; ++b)
+    r |= ((i >> b) & 1) << (bits - 1 - b);
+  return r;
+}
+
+/* Each round interleaves consecutive rows with lanes twice as wide
+ * as the round before, log2(W) rounds make the transpose */
+static void transpose_16x16_epi8(const void *const *src, void *const *dst)
+{
+  __m128i r[16], t[16];
+  for (int i = 0; i < 16; ++i)
+    r[i] = _mm_loadu_si128((const __m128i *) src[i]);
+  for (int i = 0; i < 8; ++i)
+  {
+    t[i]     = _mm_unpacklo_epi8(r[2*i], r[2*i + 1]);
+    t[i + 8] = _mm_unpackhi_epi8(r[2*i], r[2*i + 1]);
+  }
+  for (int i = 0; i < 8; ++i)
+  {
+    r[i]     = _mm_unpacklo_epi16(t[2*i], t[2*i + 1]);
+    r[i + 8] = _mm_unpackhi_epi16(t[2*i], t[2*i + 1]);
+  }
+  for (int i = 0; i < 8; ++i)
+  {
+    t[i]     = _mm_unpacklo_epi32(r[2*i], r[2*i + 1]);
+    t[i + 8] = _mm_unpackhi_epi32(r[2*i], r[2*i + 1]);
+  }
+  for (int i = 0; i < 8; ++i)
+  {
+    r[i]     = _mm_unpacklo_epi64(t[2*i], t[2*i + 1]);
+    r[i + 8] = _mm_unpackhi_epi64(t[2*i], t[2*i + 1]);
+  }
+  for (int i = 0; i < 16; ++i)
+    _mm_storeu_si128((__m128i *) dst[bit_reverse(i, 4)], r[i]);
+}
+
+static void transpose_8x8_epi16(const void *const *src, void *const *dst)
+{
+  __m128i r[8], t[8];
+  for (int i = 0; i < 8; ++i)
+    r[i] = _mm_loadu_si128((const __m128i *) src[i]);
+  for (int i = 0; i < 4; ++i)
+  {
+    t[i]     = _mm_unpacklo_epi16(r[2*i], r[2*i + 1]);
+    t[i + 4] = _mm_unpackhi_epi16(r[2*i], r[2*i + 1]);
+  }
+  for (int i = 0; i < 4; ++i)
+  {
+    r[i]     = _mm_unpacklo_epi32(t[2*i], t[2*i + 1]);
+    r[i + 4] = _mm_unpackhi_epi32(t[2*i], t[2*i + 1]);
+  }
+  for (int i = 0; i < 4; ++i)
+  {
+    t[i]     = _mm_unpacklo_epi64(r[2*i], r[2*i + 1]);
+    t[i + 4] = _mm_unpackhi_epi64(r[2*i], r[2*i + 1]);
+  }
+  for (int i = 0; i < 8; ++i)
+    _mm_storeu_si128((__m128i *) dst[bit_reverse(i, 3)], t[i]);
+}
+
+template <pc::SimdLevel L>
+static void transpose_epi32(const void *const *src, void *const *dst)
+{
+  transpose_full_tile<TileAccess::Unaligned>(
+    reinterpret_cast<const float *const *>(src),
+    reinterpret_cast<float *const *>(dst), L);
+}
+
+template <bool Conj>
+static void transpose_2x2_epi64(const void *const *src, void *const *dst)
+{
+  const __m128d a = _mm_loadu_pd((const double *) src[0]);
+  const __m128d b = _mm_loadu_pd((const double *) src[1]);
+  __m128d r0 = _mm_unpacklo_pd(a, b);
+  __m128d r1 = _mm_unpackhi_pd(a, b);
+  if constexpr (Conj)
+  {
+    const __m128d sign = _mm_set1_pd(-0.0);
+    r0 = _mm_xor_pd(r0, sign);
+    r1 = _mm_xor_pd(r1, sign);
+  }
+  _mm_storeu_pd((double *) dst[0], r0);
+  _mm_storeu_pd((double *) dst[1], r1);
+}
+
+template <bool Conj>
+__attribute__((target("avx2")))
+static void transpose_4x4_epi64(const void *const *src, void *const *dst)
+{
+  __m256d r[4];
+  for (int i = 0; i < 4; ++i)
+    r[i] = _mm256_loadu_pd((const double *) src[i]);
+
+  const __m256d t0 = _mm256_unpacklo_pd(r[0], r[1]);
+  const __m256d t1 = _mm256_unpackhi_pd(r[0], r[1]);
+  const __m256d t2 = _mm256_unpacklo_pd(r[2], r[3]);
+  const __m256d t3 = _mm256_unpackhi_pd(r[2], r[3]);
+  r[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+  r[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+  r[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+  r[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+
+  for (int i = 0; i < 4; ++i)
+  {
+    if constexpr (Conj)
+      r[i] = _mm256_xor_pd(r[i], _mm256_set1_pd(-0.0));
+    _mm256_storeu_pd((double *) dst[i], r[i]);
+  }
+}
+
+/* Same scheme as transpose16x16_ps with one round less */
+template <bool Conj>
+__attribute__((target("avx512f")))
+static void transpose_8x8_epi64(const void *const *src, void *const *dst)
+{
+  __m512d r[8], t[8];
+  for (int i = 0; i < 8; ++i)
+    r[i] = _mm512_loadu_pd((const double *) src[i]);
+  for (int k = 0; k < 4; ++k)
+  {
+    t[2*k]     = _mm512_unpacklo_pd(r[2*k], r[2*k + 1]);
+    t[2*k + 1] = _mm512_unpackhi_pd(r[2*k], r[2*k + 1]);
+  }
+
+  /* 4x4 transpose of the 128 bit lanes, t[2p + e] holding columns
+   * 2L + e of rows 2p and 2p + 1 in lane L */
+  for (int e = 0; e < 2; ++e)
+  {
+    const __m512d v0 = _mm512_shuffle_f64x2(t[e],     t[2 + e], 0x88);
+    const __m512d v1 = _mm512_shuffle_f64x2(t[e],     t[2 + e], 0xdd);
+    const __m512d w0 = _mm512_shuffle_f64x2(t[4 + e], t[6 + e], 0x88);
+    const __m512d w1 = _mm512_shuffle_f64x2(t[4 + e], t[6 + e], 0xdd);
+    r[e]     = _mm512_shuffle_f64x2(v0, w0, 0x88);
+    r[2 + e] = _mm512_shuffle_f64x2(v1, w1, 0x88);
+    r[4 + e] = _mm512_shuffle_f64x2(v0, w0, 0xdd);
+    r[6 + e] = _mm512_shuffle_f64x2(v1, w1, 0xdd);
+  }
+
+  for (int i = 0; i < 8; ++i)
+  {
+    if constexpr (Conj) /* _mm512_xor_pd needs AVX512DQ */
+      r[i] = _mm512_castsi512_pd(
+	_mm512_xor_si512(_mm512_castpd_si512(r[i]),
+			 _mm512_set1_epi64((long long) (1ull << 63))));
+    _mm512_storeu_pd((double *) dst[i], r[i]);
+  }
+}
+
+template <bool Conj>
+__attribute__((target("avx2")))
+static void transpose_2x2_epi128(const void *const *src, void *const *dst)
+{
+  const __m256d a = _mm256_loadu_pd((const double *) src[0]);
+  const __m256d b = _mm256_loadu_pd((const double *) src[1]);
+  __m256d r0 = _mm256_permute2f128_pd(a, b, 0x20);
+  __m256d r1 = _mm256_permute2f128_pd(a, b, 0x31);
+  if constexpr (Conj)
+  {
+    const __m256d sign = _mm256_setr_pd(0.0, -0.0, 0.0, -0.0);
+    r0 = _mm256_xor_pd(r0, sign);
+    r1 = _mm256_xor_pd(r1, sign);
+  }
+  _mm256_storeu_pd((double *) dst[0], r0);
+  _mm256_storeu_pd((double *) dst[1], r1);
+}
+
+template <typename T, bool Conj>
+static T element(const T &x)
+{
+  if constexpr (Conj)
+    return std::conj(x);
+  else
+    return x;
+}
+
+/*
+ * transpose_blocked for any element type: full W x W tiles go
+ * through kernel, the edges (and everything when there is no
+ * kernel) element by element.
+ */
+template <typename T, bool Conj>
+static void transpose_elements(const T *A, size_t rows, size_t cols,
+			       size_t lda, T *B, size_t ldb,
+			       size_t W, tile_kernel kernel)
+{
+  const void *s[16];
+  void *d[16];
+  for (size_t bi = 0; bi < rows; bi += PC_TRANSPOSE_BLOCK)
+    for (size_t bj = 0; bj < cols; bj += PC_TRANSPOSE_BLOCK)
+    {
+      const size_t i1 = std::min(bi + PC_TRANSPOSE_BLOCK, rows);
+      const size_t j1 = std::min(bj + PC_TRANSPOSE_BLOCK, cols);
+      for (size_t i = bi; i < i1; i += W)
+	for (size_t j = bj; j < j1; j += W)
+	{
+	  const size_t h = std::min(W, i1 - i);
+	  const size_t w = std::min(W, j1 - j);
+	  if (kernel != nullptr && h == W && w == W)
+	  {
+	    for (size_t k = 0; k < W; ++k)
+	    {
+	      s[k] = A + (i + k) * lda + j;
+	      d[k] = B + (j + k) * ldb + i;
+	    }
+	    kernel(s, d);
+	    continue;
+	  }
+	  for (size_t a = 0; a < h; ++a)
+	    for (size_t b = 0; b < w; ++b)
+	      B[(j + b) * ldb + i + a] = element<T, Conj>(A[(i + a) * lda + j + b]);
+	}
+    }
+}
+
+template <typename T, bool Conj>
+static void transpose_typed(const T *A, size_t rows, size_t cols, size_t lda,
+			    T *B, size_t ldb)
+{
+  if (lda < cols || ldb < rows) /* rows would overlap */
+    return;
+
+  const pc::SimdLevel level = pc::simdLevel();
+  size_t W = PC_TRANSPOSE_BLOCK;
+  tile_kernel kernel = nullptr;
+  if constexpr (sizeof(T) == 1)
+  {
+    W = 16;
+    kernel = transpose_16x16_epi8;
+  }
+  else if constexpr (sizeof(T) == 2)
+  {
+    W = 8;
+    kernel = transpose_8x8_epi16;
+  }
+  else if constexpr (sizeof(T) == 4)
+  {
+    W = pc::simdWidth(level);
+    kernel = level == pc::SimdLevel::AVX512 ? transpose_epi32<pc::SimdLevel::AVX512>
+           : level == pc::SimdLevel::AVX2   ? transpose_epi32<pc::SimdLevel::AVX2>
+                                            : transpose_epi32<pc::SimdLevel::SSE>;
+  }
+  else if constexpr (sizeof(T) == 8)
+  {
+    W = level == pc::SimdLevel::AVX512 ? 8 : level == pc::SimdLevel::AVX2 ? 4 : 2;
+    kernel = level == pc::SimdLevel::AVX512 ? transpose_8x8_epi64<Conj>
+           : level == pc::SimdLevel::AVX2   ? transpose_4x4_epi64<Conj>
+                                            : transpose_2x2_epi64<Conj>;
+  }
+  else if constexpr (sizeof(T) == 16)
+  {
+    if (level != pc::SimdLevel::SSE)
+    {
+      W = 2;
+      kernel = transpose_2x2_epi128<Conj>;
+    }
+  }
+  transpose_elements<T, Conj>(A, rows, cols, lda, B, ldb, W, kernel);
+}
+
+template <typename T>
+void pc::matTransposeStrided(const T *A, tenno::size rows, tenno::size cols,
+			     tenno::size lda, T *B, tenno::size ldb)
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+  transpose_typed<T, false>(A, rows, cols, lda, B, ldb);
+}
+
+template <typename T>
+void pc::matTransposeConj(const std::complex<T> *A, tenno::size rows,
+			  tenno::size cols, tenno::size lda,
+			  std::complex<T> *B, tenno::size ldb)
+{
+  transpose_typed<std::complex<T>, true>(A, rows, cols, lda, B, ldb);
+}
+
+#define PC_TRANSPOSE_TYPE(T)						\
+  template void pc::matTransposeStrided<T>(const T *, tenno::size,	\
+					   tenno::size, tenno::size,	\
+					   T *, tenno::size);
+PC_TRANSPOSE_TYPE(int8_t)
+PC_TRANSPOSE_TYPE(uint8_t)
+PC_TRANSPOSE_TYPE(int16_t)
+PC_TRANSPOSE_TYPE(uint16_t)
+PC_TRANSPOSE_TYPE(int32_t)
+PC_TRANSPOSE_TYPE(uint32_t)
+PC_TRANSPOSE_TYPE(float)
+PC_TRANSPOSE_TYPE(int64_t)
+PC_TRANSPOSE_TYPE(uint64_t)
+PC_TRANSPOSE_TYPE(double)
+PC_TRANSPOSE_TYPE(std::complex<float>)
+PC_TRANSPOSE_TYPE(std::complex<double>)
+#undef PC_TRANSPOSE_TYPE
+
+template void pc::matTransposeConj<float>(const std::complex<float> *,
+					  tenno::size, tenno::size, tenno::size,
+					  std::complex<float> *, tenno::size);
+template void pc::matTransposeConj<double>(const std::complex<double> *,
+					   tenno::size, tenno::size, tenno::size,
+					   std::complex<double> *, tenno::size);
+
+
+/*============================================*\
+|                   IN PLACE                   |
+\*============================================*/
+
+/*
+ * Walks the upper triangle of tiles. Each off diagonal tile (i,j)
+ * is swapped with its mirror (j,i) through a buffer the size of one
+ * tile: (j,i) is transposed into the buffer, (i,j) is transposed
+ * into the place of (j,i), and the buffer is copied into (i,j). The
+ * only extra memory is the buffer, which stays in L1.
+ */
+template <typename Rows>
+static void transpose_in_place(Rows rows, size_t N, pc::SimdLevel level)
+{
+  const size_t W = pc::simdWidth(level);
+
+  alignas(64) float buf[16 * 16];
+  float *b[16];
+  for (size_t k = 0; k < W; ++k)
+    b[k] = buf + k * W;
+
+  const float *s[16];
+  float *d[16];
+  for (size_t i = 0; i < N; i += W)
+  {
+    const size_t h = std::min(W, N - i);
+
+    /* Diagonal tile, in registers */
+    for (size_t k = 0; k < h; ++k)
+      d[k] = rows(i + k) + i;
+    if (h == W || level != pc::SimdLevel::SSE)
+      transpose_tile(d, d, h, h, level);
+    else
+      for (size_t x = 0; x < h; ++x)
+	for (size_t y = x + 1; y < h; ++y)
+	  std::swap(d[x][y], d[y][x]);
+
+    for (size_t j = i + W; j < N; j += W)
+    {
+      const size_t w = std::min(W, N - j);
+
+      for (size_t k = 0; k < w; ++k)
+	s[k] = rows(j + k) + i;
+      transpose_tile(s, b, w, h, level);
+
+      for (size_t k = 0; k < h; ++k)
+	s[k] = rows(i + k) + j;
+      for (size_t k = 0; k < w; ++k)
+	d[k] = rows(j + k) + i;
+      transpose_tile(s, d, h, w, level);
+
+      for (size_t k = 0; k < h; ++k)
+	std::memcpy(rows(i + k) + j, b[k], w * sizeof(float));
+    }
+  }
+}
+
+void pc::matTransposeInPlace(float *M, tenno::size N)
+{
+  transpose_in_place([M, N](size_t i) { return M + i * N; },
+		     N, pc::simdLevel());
+}
+
+void pc::matTransposeInPlace(float **M, tenno::size N)
+{
+  transpose_in_place([M](size_t i) { return M[i]; },
+		     N, pc::simdLevel());
+}
+
+
+/*
+ * Rectangular in place transpose by cycle following. Seen as a
+ * rows x cols matrix of units of c floats, the unit that ends up at
+ * position k of the cols x rows result comes from position
+ * (k % rows) * cols + k / rows, and following this map from any
+ * position walks a cycle back to it. Each cycle is moved by its
+ * leader, its smallest position, which a thread recognizes by
+ * walking the indices alone. Moved positions are marked in a bitset
+ * so the other threads skip them without walking. The same map is
+ * applied to `panels` consecutive matrices at once.
+ */
+
+/* Cycles moved in lock step, to keep several misses in flight */
+#define PC_CYCLE_BATCH 8
+/* Starting positions handed to a thread at a time */
+#define PC_CYCLE_CHUNK 4096
+
+static inline size_t cycle_source(size_t k, size_t rows, size_t cols)
+{
+  return (k % rows) * cols + k / rows;
+}
+
+static bool cycle_leader(size_t k, size_t rows, size_t cols)
+{
+  size_t j = cycle_source(k, rows, cols);
+  while (j > k)
+    j = cycle_source(j, rows, cols);
+  return j == k;
+}
+
+static inline bool cycle_visited(const uint64_t *visited, size_t k)
+{
+  uint64_t word;
+  #pragma omp atomic read
+  word = visited[k / 64];
+  return (word >> (k % 64)) & 1;
+}
+
+static inline void cycle_mark(uint64_t *visited, size_t k)
+{
+  const uint64_t bit = uint64_t(1) << (k % 64);
+  #pragma omp atomic update
+  visited[k / 64] |= bit;
+}
+
+static void follow_cycles(float *M, size_t rows, size_t cols,
+			  size_t c, size_t panels, uint64_t *visited,
+			  const size_t *leaders, size_t count, float *tmp)
+{
+  constexpr size_t done = SIZE_MAX;
+  const size_t bytes = c * sizeof(float);
+  const size_t stride = rows * cols * c;
+  size_t cur[PC_CYCLE_BATCH];
+  for (size_t b = 0; b < count; ++b)
+  {
+    for (size_t p = 0; p < panels; ++p)
+      std::memcpy(tmp + (b * panels + p) * c,
+		  M + p * stride + leaders[b] * c, bytes);
+    cur[b] = leaders[b];
+  }
+
+  size_t active = count;
+  while (active > 0)
+    for (size_t b = 0; b < count; ++b)
+    {
+      if (cur[b] == done)
+	continue;
+      cycle_mark(visited, cur[b]);
+      const size_t next = cycle_source(cur[b], rows, cols);
+      if (next == leaders[b])
+      {
+	for (size_t p = 0; p < panels; ++p)
+	  std::memcpy(M + p * stride + cur[b] * c,
+		      tmp + (b * panels + p) * c, bytes);
+	cur[b] = done;
+	--active;
+      }
+      else
+      {
+	for (size_t p = 0; p < panels; ++p)
+	  std::memcpy(M + p * stride + cur[b] * c,
+		      M + p * stride + next * c, bytes);
+	cur[b] = next;
+      }
+    }
+}
+
+static void transpose_cycles(float *M, size_t rows, size_t cols,
+			     size_t c, size_t panels)
+{
+  if (rows <= 1 || cols <= 1) /* same memory layout */
+    return;
+
+  /* The first and the last unit never move */
+  const size_t L = rows * cols;
+  std::vector<uint64_t> bits((L + 63) / 64, 0);
+  uint64_t *visited = bits.data();
+
+  #pragma omp parallel
+  {
+    std::vector<float> tmp(PC_CYCLE_BATCH * panels * c);
+
+    #pragma omp for schedule(dynamic, 1)
+    for (size_t chunk = 1; chunk < L - 1; chunk += PC_CYCLE_CHUNK)
+    {
+      const size_t end = std::min(chunk + PC_CYCLE_CHUNK, L - 1);
+      size_t leaders[PC_CYCLE_BATCH];
+      size_t count = 0;
+      for (size_t k = chunk; k < end; ++k)
+      {
+	if (cycle_visited(visited, k) || !cycle_leader(k, rows, cols))
+	  continue;
+	leaders[count++] = k;
+	if (count == PC_CYCLE_BATCH)
+	{
+	  follow_cycles(M, rows, cols, c, panels, visited,
+			leaders, count, tmp.data());
+	  count = 0;
+	}
+      }
+      follow_cycles(M, rows, cols, c, panels, visited,
+		    leaders, count, tmp.data());
+    }
+  }
+}
+
+/*
+ * Short runs leave the cycles above with about one cache miss per
+ * element, so shapes with gcd(rows, cols) below PC_INPLACE_MIN_RUN
+ * are split in permutations of whole rows and columns instead, after
+ * Catanzaro, Keller and Garland, "A decomposition for in-place matrix
+ * transposition". The element at (i, j) of the m x n matrix goes to
+ * the linear position t = j * m + i, that is (t / n, t % n) in the
+ * same m x n view. With c = gcd(m, n), a = m / c and b = n / c:
+ *  1. column j is rotated up by -(j / b), only needed if c > 1;
+ *  2. in each row, the element from row i at column j moves to
+ *     column (j * m + i) % n;
+ *  3. column j is rotated up by j, then row r takes the row
+ *     (r * n + r / a) % m.
+ * Every step streams the matrix: the columns are rotated in place a
+ * panel at a time and the rows are moved whole, through a buffer of
+ * one row per thread. Thin shapes take the same path, so no step
+ * needs memory proportional to the matrix.
+ */
+#define PC_INPLACE_MIN_RUN 32
+/* Columns rotated together, a panel row is a cache line */
+#define PC_INPLACE_PANEL 16
+
+/*
+ * Row r of column j takes row (r + shift(j)) % m, shift(j) < m.
+ * Rotating up by s is reversing rows [0, s) and [s, m) of the column
+ * and then the whole column: the first two go a panel of columns at
+ * a time, the last one is the same for every column and swaps whole
+ * rows. Nothing is buffered.
+ */
+template <typename Shift>
+static void rotate_columns(float *M, size_t m, size_t n, Shift shift)
+{
+  #pragma omp parallel for schedule(static)
+  for (size_t j0 = 0; j0 < n; j0 += PC_INPLACE_PANEL)
+  {
+    const size_t w = std::min<size_t>(PC_INPLACE_PANEL, n - j0);
+    size_t s[PC_INPLACE_PANEL];
+    for (size_t j = 0; j < w; ++j)
+      s[j] = shift(j0 + j);
+
+    /* Step k swaps rows close to k and to the ends of the segments,
+     * so the rows of the panel stay in cache */
+    float *P = M + j0;
+    for (size_t k = 0; k < m / 2; ++k)
+      for (size_t j = 0; j < w; ++j)
+      {
+	if (2 * k + 1 < s[j])
+	  std::swap(P[k * n + j], P[(s[j] - 1 - k) * n + j]);
+	if (2 * k + 1 < m - s[j])
+	  std::swap(P[(s[j] + k) * n + j], P[(m - 1 - k) * n + j]);
+      }
+  }
+
+  #pragma omp parallel for schedule(static)
+  for (size_t k = 0; k < m / 2; ++k)
+    std::swap_ranges(M + k * n, M + (k + 1) * n, M + (m - 1 - k) * n);
+}
+
+/* Row r takes row source(r), following the cycles of source */
+template <typename Source>
+static void permute_rows(float *M, size_t m, size_t n, Source source)
+{
+  const size_t bytes = n * sizeof(float);
+  std::vector<bool> moved(m, false);
+  std::vector<float> tmp(n);
+  for (size_t start = 0; start < m; ++start)
+  {
+    if (moved[start])
+      continue;
+    moved[start] = true;
+    size_t cur = start;
+    size_t next = source(start);
+    if (next == start)
+      continue;
+
+    std::memcpy(tmp.data(), M + start * n, bytes);
+    while (next != start)
+    {
+      std::memcpy(M + cur * n, M + next * n, bytes);
+      moved[next] = true;
+      cur = next;
+      next = source(cur);
+    }
+    std::memcpy(M + cur * n, tmp.data(), bytes);
+  }
+}
+
+static void transpose_decomposed(float *M, size_t m, size_t n)
+{
+  const size_t c = std::gcd(m, n);
+  const size_t a = m / c;
+  const size_t b = n / c;
+
+  if (c > 1)
+    rotate_columns(M, m, n, [m, b](size_t j) {
+      return (m - j / b % m) % m;
+    });
+
+  #pragma omp parallel
+  {
+    std::vector<float> tmp(n);
+    const size_t m_mod_n = m % n;
+
+    #pragma omp for schedule(static)
+    for (size_t r = 0; r < m; ++r)
+    {
+      float *row = M + r * n;
+      size_t jm = 0; /* j * m % n */
+      for (size_t q = 0; q < c; ++q)
+      {
+	/* Row of the elements before step 1, mod n */
+	const size_t i = (r + m - q) % m % n;
+	for (size_t j = q * b; j < (q + 1) * b; ++j)
+	{
+	  size_t d = jm + i;
+	  if (d >= n)
+	    d -= n;
+	  tmp[d] = row[j];
+	  jm += m_mod_n;
+	  if (jm >= n)
+	    jm -= n;
+	}
+      }
+      std::memcpy(row, tmp.data(), n * sizeof(float));
+    }
+  }
+
+  rotate_columns(M, m, n, [m](size_t j) { return j % m; });
+  permute_rows(M, m, n, [m, n, a](size_t r) {
+    return (r * n + r / a) % m;
+  });
+}
+
+/*
+ * Following single floats makes one random access per element. With
+ * g = gcd(rows, cols) the cycles move runs of g floats instead:
+ *  1. the rows x cols/g matrix of g wide runs is transposed, which
+ *     leaves cols/g panels of rows x g floats, one after the other;
+ *  2. every g x g block of the panels is transposed with the SIMD
+ *     square kernel;
+ *  3. in every panel the (rows/g) x g matrix of g wide runs is
+ *     transposed, and the panels are the rows of the result.
+ * Shapes with shorter runs use transpose_decomposed.
+ */
+void pc::matTransposeInPlace(float *M, tenno::size rows, tenno::size cols)
+{
+  if (rows == cols)
+  {
+    matTransposeInPlace(M, rows);
+    return;
+  }
+  if (rows <= 1 || cols <= 1) /* same memory layout */
+    return;
+
+  const size_t g = std::gcd(rows, cols);
+  if (g < PC_INPLACE_MIN_RUN)
+  {
+    transpose_decomposed(M, rows, cols);
+    return;
+  }
+
+  transpose_cycles(M, rows, cols / g, g, 1);
+
+  const size_t blocks = rows * cols / (g * g);
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < blocks; ++b)
+    matTransposeInPlace(M + b * g * g, g);
+
+  transpose_cycles(M, rows / g, g, g, cols / g);
+}
+
+
+/*============================================*\
+|                CACHE OBLIVIOUS               |
+\*============================================*/
+
+/* Sub-matrices at most this wide are transposed directly, a leaf
+ * of the input and one of the output fit together in L1 */
+#define PC_RECURSIVE_LEAF 64
+
+/*
+ * Splits the longest side of the sub-matrix in half until it fits
+ * in a leaf. The split point is rounded to a multiple of the leaf
+ * so that only the last block of a row or column can be ragged.
+ * No cache size appears anywhere: at some depth of the recursion
+ * the two blocks fit in every level of the hierarchy.
+ */
+template <typename Src, typename Dst>
+static void transpose_recursive(Src src, Dst dst,
+				size_t r0, size_t r1,
+				size_t c0, size_t c1,
+				pc::SimdLevel level)
+{
+  const size_t rows = r1 - r0;
+  const size_t cols = c1 - c0;
+  if (rows <= PC_RECURSIVE_LEAF && cols <= PC_RECURSIVE_LEAF)
+  {
+    transpose_tiles(src, dst, r0, r1, c0, c1, level);
+    return;
+  }
+
+  if (rows >= cols)
+  {
+    const size_t mid = r0 + (rows / 2 + PC_RECURSIVE_LEAF - 1)
+                              / PC_RECURSIVE_LEAF * PC_RECURSIVE_LEAF;
+    transpose_recursive(src, dst, r0, mid, c0, c1, level);
+    transpose_recursive(src, dst, mid, r1, c0, c1, level);
+  }
+  else
+  {
+    const size_t mid = c0 + (cols / 2 + PC_RECURSIVE_LEAF - 1)
+                              / PC_RECURSIVE_LEAF * PC_RECURSIVE_LEAF;
+    transpose_recursive(src, dst, r0, r1, c0, mid, level);
+    transpose_recursive(src, dst, r0, r1, mid, c1, level);
+  }
+}
+
+void pc::matTransposeRecursive(float **M, float **T, tenno::size N)
+{
+  transpose_recursive([M](size_t i) { return M[i]; },
+		      [T](size_t i) { return T[i]; },
+		      0, N, 0, N, pc::simdLevel());
+}
+
+void pc::matTransposeRecursiveCyclic(float *M, float *T, tenno::size N)
+{
+  transpose_recursive([M, N](size_t i) { return M + i * N; },
+		      [T, N](size_t i) { return T + i * N; },
+		      0, N, 0, N, pc::simdLevel());
+}
+
+
+/*============================================*\
+|                     OMP                      |
+\*============================================*/
+
 /*
-Linux strikes again arch/x86/crypto/aria-aesni-avc2-asm_64.S
-#define transpose_4x4(x0, x1, x2, x3, t1, t2)		\
-	vpunpckhdq x1, x0, t2;				\
-	vpunpckldq x1, x0, x0;				\
-							\
-	vpunpckldq x3, x2, t1;				\
-	vpunpckhdq x3, x2, x2;				\
-							\
-	vpunpckhqdq t1, x0, x1;				\
-	vpunpcklqdq t1, x0, x0;				\
-							\
-	vpunpckhqdq x2, t2, x3;				\
-	vpunpcklqdq x2, t2, x2;
+ * Runs body(a, b) for every a < n0, b < n1 on a team of threads,
+ * then finish() once on each thread.
+ * The schedule is applied with omp_set_schedule() and schedule(runtime)
+ * and the caller's one is restored afterwards. collapse must be a
+ * constant in the pragma, hence the two loops.
+ */
+template <typename Body, typename Finish>
+static void omp_for_2d(size_t n0, size_t n1, const pc::OmpOptions &opts,
+		       Body body, Finish finish)
+{
+  pc::OmpScheduleScope scope(opts);
 
-transpose_4x4_f32_intrinsic is the intrinsic version of the above code
-*/
-void transpose_4x4_f32_intrinsic(const float *src0,
-                                 const float *src1, 
-                                 const float *src2,
-                                 const float *src3,
-                                 float *dst0,
-                                 float *dst1,
-                                 float *dst2,
-                                 float *dst3) {
+  #pragma omp parallel num_threads(pc::ompThreads(opts))
+  {
+    if (opts.collapse >= 2)
+    {
+      #pragma omp for schedule(runtime) collapse(2) nowait
+      for (size_t a = 0; a < n0; ++a)
+	for (size_t b = 0; b < n1; ++b)
+	  body(a, b);
+    }
+    else
+    {
+      #pragma omp for schedule(runtime) nowait
+      for (size_t a = 0; a < n0; ++a)
+	for (size_t b = 0; b < n1; ++b)
+	  body(a, b);
+    }
+    finish();
+  }
+}
 
-    __m128 row0 = _mm_loadu_ps(src0); // Load Rows
-    __m128 row1 = _mm_loadu_ps(src1);
-    __m128 row2 = _mm_loadu_ps(src2);
-    __m128 row3 = _mm_loadu_ps(src3);
+template <typename Body>
+static void omp_for_2d(size_t n0, size_t n1, const pc::OmpOptions &opts,
+		       Body body)
+{
+  omp_for_2d(n0, n1, opts, body, [] {});
+}
 
-    // Unpack and interleave rows
-    __m128 t0 = _mm_unpacklo_ps(row0, row1);
-    __m128 t1 = _mm_unpackhi_ps(row0, row1);
-    __m128 t2 = _mm_unpacklo_ps(row2, row3);
-    __m128 t3 = _mm_unpackhi_ps(row2, row3);
+/* One iteration per tile of the dispatched kernel */
+template <typename Src, typename Dst>
+static void transpose_tiles_omp(Src src, Dst dst, size_t rows, size_t cols,
+				size_t side, const pc::OmpOptions &opts,
+				TileAccess access = TileAccess::Unaligned)
+{
+  const pc::SimdLevel level = pc::simdLevel();
+  omp_for_2d((rows + side - 1) / side, (cols + side - 1) / side, opts,
+	     [=](size_t a, size_t b)
+	     {
+	       const size_t i = a * side;
+	       const size_t j = b * side;
+	       transpose_tiles(src, dst,
+			       i, std::min(i + side, rows),
+			       j, std::min(j + side, cols),
+			       level, access);
+	     },
+	     [access]
+	     {
+	       if (access == TileAccess::Stream)
+		 _mm_sfence();
+	     });
+}
 
-    // Shuffle to form transposed rows
-    __m128 d0 = _mm_movelh_ps(t0, t2);
-    __m128 d1 = _mm_movehl_ps(t2, t0);
-    __m128 d2 = _mm_movelh_ps(t1, t3);
-    __m128 d3 = _mm_movehl_ps(t3, t1);
+void pc::matTransposeCyclicOMP(float *M, float *T, tenno::size N,
+			       const OmpOptions &opts)
+{
+  omp_for_2d(N, N, opts,
+	     [=](size_t i, size_t j) { T[i*N + j] = M[j*N + i]; });
+}
 
-    // Store transposed rows
-    _mm_storeu_ps(dst0, d0);
-    _mm_storeu_ps(dst1, d1);
-    _mm_storeu_ps(dst2, d2);
-    _mm_storeu_ps(dst3, d3);
+void pc::matTransposeIntrinsicOMP(float **mat_in, float **mat_out,
+				  size_t N, const OmpOptions &opts)
+{
+  transpose_tiles_omp([mat_in](size_t i) { return mat_in[i]; },
+		      [mat_out](size_t i) { return mat_out[i]; },
+		      N, N, pc::simdWidth(pc::simdLevel()), opts);
 }
 
-void pc::matTransposeIntrinsicCyclic(float *mat_in, float *mat_out, size_t N)
+void pc::matTransposeIntrinsicCyclicOMP(float *mat_in, float *mat_out,
+					size_t N, const OmpOptions &opts)
 {
-    for (size_t i = 0; i < N; i += 4) {
-        for (size_t j = 0; j < N; j += 4) {
-            transpose_4x4_f32_intrinsic(
-                            &mat_in[i * N + j], 
-                            &mat_in[(i + 1) * N + j], 
-                            &mat_in[(i + 2) * N + j], 
-                            &mat_in[(i + 3) * N + j], 
-                            &mat_out[j * N + i],
-                            &mat_out[(j + 1) * N + i],
-                            &mat_out[(j + 2) * N + i],
-                            &mat_out[(j + 3) * N + i]);
-        }
-    }
+  transpose_tiles_omp([mat_in, N](size_t i) { return mat_in + i * N; },
+		      [mat_out, N](size_t i) { return mat_out + i * N; },
+		      N, N, pc::simdWidth(pc::simdLevel()), opts,
+		      cyclic_access(mat_out, N, N, pc::simdLevel()));
 }
 
-void pc::matTransposeIntrinsic(float **mat_in, float **mat_out, size_t N)
+void pc::matTransposeStridedOMP(const float *A, tenno::size rows,
+				tenno::size cols, tenno::size lda,
+				float *B, tenno::size ldb,
+				const OmpOptions &opts)
 {
-    for (size_t i = 0; i < N; i += 4) {
-        for (size_t j = 0; j < N; j += 4) {
-            transpose_4x4_f32_intrinsic(
-                            &mat_in[i][j], 
-                            &mat_in[i + 1][j], 
-                            &mat_in[i + 2][j], 
-                            &mat_in[i + 3][j], 
-                            &mat_out[j][i],
-                            &mat_out[j + 1][i],
-                            &mat_out[j + 2][i],
-                            &mat_out[j + 3][i]);
-        }
+  if (lda < cols || ldb < rows) /* rows would overlap */
+    return;
+
+  transpose_tiles_omp([A, lda](size_t i) { return A + i * lda; },
+		      [B, ldb](size_t i) { return B + i * ldb; },
+		      rows, cols, PC_TRANSPOSE_BLOCK, opts);
+}
+
+
+/*============================================*\
+|                    BATCH                     |
+\*============================================*/
+
+/*
+ * An 8x8 matrix fills only half a zmm, so two of them go through the
+ * network of transpose8x8_ps together: row i of A in the low half and
+ * row i of B in the high one. Unpacks and shuffles stay inside 128
+ * bit lanes, only the last step that swaps the lanes of each half
+ * needs a permutation across the register.
+ */
+__attribute__((target("avx512f")))
+static void transpose_8x8_pair_avx512(const float *A, const float *B,
+				      float *TA, float *TB)
+{
+  __m512 r[8], t[8], s[8];
+  for (int i = 0; i < 8; ++i)
+    r[i] = _mm512_castpd_ps(_mm512_insertf64x4(
+	     _mm512_castpd256_pd512(_mm256_castps_pd(_mm256_loadu_ps(A + 8*i))),
+	     _mm256_castps_pd(_mm256_loadu_ps(B + 8*i)), 1));
+
+  for (int k = 0; k < 4; ++k)
+  {
+    t[2*k]     = _mm512_unpacklo_ps(r[2*k], r[2*k + 1]);
+    t[2*k + 1] = _mm512_unpackhi_ps(r[2*k], r[2*k + 1]);
+  }
+  for (int k = 0; k < 2; ++k)
+  {
+    s[4*k]     = _mm512_shuffle_ps(t[4*k],     t[4*k + 2], _MM_SHUFFLE(1, 0, 1, 0));
+    s[4*k + 1] = _mm512_shuffle_ps(t[4*k],     t[4*k + 2], _MM_SHUFFLE(3, 2, 3, 2));
+    s[4*k + 2] = _mm512_shuffle_ps(t[4*k + 1], t[4*k + 3], _MM_SHUFFLE(1, 0, 1, 0));
+    s[4*k + 3] = _mm512_shuffle_ps(t[4*k + 1], t[4*k + 3], _MM_SHUFFLE(3, 2, 3, 2));
+  }
+
+  /* permute2f128 0x20 and 0x31 of each half */
+  const __m512i lo = _mm512_setr_epi32(0, 1, 2, 3, 16, 17, 18, 19,
+				       8, 9, 10, 11, 24, 25, 26, 27);
+  const __m512i hi = _mm512_setr_epi32(4, 5, 6, 7, 20, 21, 22, 23,
+				       12, 13, 14, 15, 28, 29, 30, 31);
+  for (int k = 0; k < 4; ++k)
+  {
+    r[k]     = _mm512_permutex2var_ps(s[k], lo, s[k + 4]);
+    r[k + 4] = _mm512_permutex2var_ps(s[k], hi, s[k + 4]);
+  }
+
+  for (int i = 0; i < 8; ++i)
+  {
+    _mm256_storeu_ps(TA + 8*i, _mm512_castps512_ps256(r[i]));
+    _mm256_storeu_ps(TB + 8*i, _mm256_castpd_ps(
+		       _mm512_extractf64x4_pd(_mm512_castps_pd(r[i]), 1)));
+  }
+}
+
+/* Sizes without a fixed instance, up to a block and multiple of 4:
+ * whole tiles of the widest level dividing N, with no blocking and no
+ * edges */
+template <pc::SimdLevel K>
+static void transpose_flat(const float *M, float *T, size_t N)
+{
+  constexpr size_t W = pc::simdWidth(K);
+  const float *s[W];
+  float *d[W];
+  for (size_t i = 0; i < N; i += W)
+    for (size_t j = 0; j < N; j += W)
+    {
+      for (size_t k = 0; k < W; ++k)
+      {
+	s[k] = M + (i + k) * N + j;
+	d[k] = T + (j + k) * N + i;
+      }
+      transpose_full_tile<TileAccess::Unaligned>(s, d, K);
     }
 }
 
+using FlatKernel = void (*)(const float *, float *, size_t);
+
+static FlatKernel flat_kernel(size_t N, pc::SimdLevel level)
+{
+  if (N % 16 == 0 && level == pc::SimdLevel::AVX512)
+    return transpose_flat<pc::SimdLevel::AVX512>;
+  if (N % 8 == 0 && level != pc::SimdLevel::SSE)
+    return transpose_flat<pc::SimdLevel::AVX2>;
+  return transpose_flat<pc::SimdLevel::SSE>;
+}
+
+/* The kernel is resolved once for the whole batch; an iteration is a
+ * matrix, or a pair of them for 8x8 on AVX-512 */
+template <typename Src, typename Dst>
+static void transpose_batch(Src src, Dst dst, tenno::size N,
+			    tenno::size count, const pc::OmpOptions &opts)
+{
+  const pc::SimdLevel level = pc::simdLevel();
+  const FixedKernel kernel = fixed_kernel(N, level);
+  if (N == 8 && level == pc::SimdLevel::AVX512)
+  {
+    omp_for_2d((count + 1) / 2, 1, opts,
+	       [=](size_t p, size_t)
+	       {
+		 const size_t k = 2 * p;
+		 if (k + 1 < count)
+		   transpose_8x8_pair_avx512(src(k), src(k + 1),
+					     dst(k), dst(k + 1));
+		 else
+		   kernel(src(k), dst(k));
+	       });
+    return;
+  }
+
+  const FlatKernel flat = !kernel && N % 4 == 0 && N <= PC_TRANSPOSE_BLOCK
+    ? flat_kernel(N, level) : nullptr;
+  omp_for_2d(count, 1, opts,
+	     [=](size_t k, size_t)
+	     {
+	       if (kernel)
+		 kernel(src(k), dst(k));
+	       else if (flat)
+		 flat(src(k), dst(k), N);
+	       else
+		 pc::matTransposeStrided(src(k), N, N, N, dst(k), N);
+	     });
+}
+
+void pc::matTransposeBatch(const float *M, float *T, tenno::size N,
+			   tenno::size count, const OmpOptions &opts)
+{
+  const size_t size = N * N;
+  transpose_batch([M, size](size_t k) { return M + k * size; },
+		  [T, size](size_t k) { return T + k * size; },
+		  N, count, opts);
+}
+
+void pc::matTransposeBatch(const float *const *M, float *const *T,
+			   tenno::size N, tenno::size count,
+			   const OmpOptions &opts)
+{
+  transpose_batch([M](size_t k) { return M[k]; },
+		  [T](size_t k) { return T[k]; },
+		  N, count, opts);
+}
+
 
 /*============================================*\
 |                     MPI                      |
@@ -292,148 +1786,159 @@ void pc::matTransposeMPINonblocking(float *M, float *T, tenno::size N)
 }
 void pc::matTransposeMPIBlock(float *M, float *T, tenno::size N)
 {
-  if (world_size > (int) (N * N) || world_size < 4) /* fallback */
-  {
-    if (world_rank == 0)
-    {
-      for (tenno::size i = 0; i < N*N; ++i)
-	T[i] = M[N*(i % N) + (i / N)];
-    }
+  /* Any number of ranks: the blocks of a P x Q grid differ in size
+   * by a row or a column, rank 0 scatters them straight from M and
+   * gathers the transposes straight into T through submatrix types */
+  int P, Q;
+  mpiGridDims(P, Q);
+
+  size_t r0, h, c0, w;
+  pc::mpiGridBlock(N, P, Q, world_rank, r0, h, c0, w);
+  std::vector<float> block(h * w);
+  if (mpiScatterGrid(M, N, P, Q, false, block.data()) != MPI_SUCCESS)
     return;
-  }
 
-  /* Calculate the displacement */
-  int block_side = (int)N/int(sqrt(world_size));
-  float *block = new float[block_side * block_side];
-  int *displacements = new int[world_size];
-  int *displacements_transposed = new int[world_size];
-  int *counts = new int[world_size];
-  for (int i = 0; i < world_size; ++i)
-  { /* Displacement of block types, assuming a stride of sizeof(float) beween 2 blocks */
-    displacements[i] =
-                 ((i*block_side)%(int)N)        /* col */
-               + (i*block_side/(int)N)*(int)N*block_side; /* row    */
-    displacements_transposed[i] =
-                 ((i*block_side)%(int)N)*(int)N /* col */
-               + (i*block_side/(int)N)*block_side;       /*  row */
-    counts[i] = 1;
-  }
+  /* The w x h transpose takes the place of the block, and goes to
+   * (c0, r0) */
+  matTransposeInPlace(block.data(), h, w);
 
-  /* Debug */
-  /*
-  if (world_rank == 0)
-  {
-  printf("Displacements:\n");
-  for (int i = 0; i < world_size; ++i)
-      printf("%d ", displacements[i]);
-  printf("\n");
-  for (int i = 0; i < world_size; ++i)
-      printf("%d ", displacements_transposed[i]);
-  printf("\n");
-  }
-  */
+  mpiGatherGrid(block.data(), T, N, P, Q, true);
+}
 
-  //printf("Lots of processes\n");
+void pc::matTransposeMPIAlltoall(const float *rows, float *rows_t,
+				 tenno::size N, tenno::size ld_in,
+				 tenno::size ld_out)
+{
+  if (ld_in < N || ld_out < N)
+    return;
+  /* Counts and displacements are ints and add up to the h x N floats
+   * of a rank; checked on the widest rank so that all of them agree */
+  if (((N + (size_t) world_size - 1) / (size_t) world_size) * N > INT_MAX)
+    return;
 
-  MPI_Datatype block_t_tmp, block_t;
-  int err = MPI_Type_vector(block_side, /* count       */
-                         block_side,    /* blocklength */
-			 (int)N,        /* stride      */
-			 MPI_FLOAT,     /* oldtype     */
-			 &block_t_tmp); /* newtype     */
-  if (err != MPI_SUCCESS)
+  /* Rank s gets our h x h_s block of its columns and sends back its
+   * h_s x h block of ours, which we transpose into columns s */
+  const size_t r0 = mpiRowBegin(N, world_rank);
+  const size_t h = mpiRowBegin(N, world_rank + 1) - r0;
+  std::vector<int> send_counts(world_size), recv_counts(world_size);
+  std::vector<int> displacements(world_size);
+  int offset = 0;
+  for (int s = 0; s < world_size; ++s)
   {
-    delete[] block;
-    delete[] counts;
-    delete[] displacements;
-    delete[] displacements_transposed;
-    return;
+    const size_t h_s = mpiRowBegin(N, s + 1) - mpiRowBegin(N, s);
+    send_counts[s] = recv_counts[s] = (int) (h * h_s);
+    displacements[s] = offset;
+    offset += send_counts[s];
   }
-  err = MPI_Type_create_resized(block_t_tmp,     /* oldtype */
-				 0,             /* lb      */
-				 sizeof(float), /* extent  */
-				 &block_t);       /* newtype */
-  err = MPI_Type_commit(&block_t);
-  if (err != MPI_SUCCESS)
+
+  std::vector<float> send(h * N), recv(h * N);
+  for (int s = 0; s < world_size; ++s)
   {
-    delete[] block;
-    delete[] counts;
-    delete[] displacements;
-    delete[] displacements_transposed;
-    return;
+    const size_t c0 = mpiRowBegin(N, s);
+    const size_t h_s = mpiRowBegin(N, s + 1) - c0;
+    for (size_t i = 0; i < h; ++i)
+      std::memcpy(send.data() + displacements[s] + i * h_s,
+		  rows + i * ld_in + c0, h_s * sizeof(float));
   }
-  MPI_Type_free(&block_t_tmp);
 
-  //printf("Scattering\n");
-  
-  err = MPI_Scatterv(M,                /* sendbuf       */
-		     counts,           /* sendcount     */
-                     displacements,    /* displacements */
-		     block_t,          /* sendtype      */
-		     block,            /* recvbuf       */
-		     block_side * block_side, /* recvcount */
-		     MPI_FLOAT,        /* recvtype      */
-		     0,                /* root          */
- 		     MPI_COMM_WORLD);  /* comm          */
+  int err;
+  if (N % world_size == 0)
+    err = MPI_Alltoall(send.data(),    /* sendbuf   */
+		       (int) (h * h),  /* sendcount */
+		       MPI_FLOAT,      /* sendtype  */
+		       recv.data(),    /* recvbuf   */
+		       (int) (h * h),  /* recvcount */
+		       MPI_FLOAT,      /* recvtype  */
+		       MPI_COMM_WORLD);
+  else
+    err = MPI_Alltoallv(send.data(), send_counts.data(),
+			displacements.data(), MPI_FLOAT,
+			recv.data(), recv_counts.data(),
+			displacements.data(), MPI_FLOAT, MPI_COMM_WORLD);
   if (err != MPI_SUCCESS)
-    goto end;
+    return;
 
-  //printf("Scattered\n");
-  /*
-  if (pc::world_rank == 0)
-  {
-  for (size_t i = 0; i < block_side * block_side; ++i)
+  for (int s = 0; s < world_size; ++s)
   {
-      if (i % block_side == 0 && i != 0)
-        fprintf(stdout, "\n");
-      fprintf(stdout, "%f ", block[i]);
-  }
-  printf("\n");
+    const size_t c0 = mpiRowBegin(N, s);
+    const size_t h_s = mpiRowBegin(N, s + 1) - c0;
+    matTransposeStrided(recv.data() + displacements[s], h_s, h, h,
+			rows_t + c0, ld_out);
   }
-  */
+}
 
-  /* Transpose the block */
-  //printf("Transposed:\n");
-  for (int i = 0; i < (int) (block_side); ++i)
-    for (int j = i; j < (int) (block_side); ++j)
-        std::swap(block[block_side*i + j], block[j*block_side + i]);
-  /*
-  if (pc::world_rank == 0)
-  {
-  fprintf(stdout, "Transposed: \n");
-  for (size_t i = 0; i < block_side * block_side; ++i)
-  {
-      if (i % block_side == 0 && i != 0)
-        fprintf(stdout, "\n");
-      fprintf(stdout, "%f ", block[i]);
-  }
-  printf("\n");
-  }
-  */
+void pc::matTransposeMPIAlltoallw(const float *rows, float *rows_t,
+				  tenno::size N, tenno::size ld_in,
+				  tenno::size ld_out)
+{
+  if (ld_in < N || ld_out < N)
+    return;
+  /* Strides and byte displacements are ints */
+  if (ld_in > INT_MAX || ld_out > INT_MAX || N * sizeof(float) > INT_MAX)
+    return;
 
-  // printf("Gathering\n");
+  const size_t r0 = mpiRowBegin(N, world_rank);
+  const size_t h = mpiRowBegin(N, world_rank + 1) - r0;
 
-  err = MPI_Gatherv(block,                 /* sendbuf   */
-		    block_side * block_side,                    /* sendcount */
-		    MPI_FLOAT,              /* sendtype  */
-		    T,                    /* recvbuf   */
-		    counts,           /* recvcount */
-		    displacements_transposed, /* displacements */
-		    block_t,   /* recvtype  */
-		    0,                    /* root      */
-		    MPI_COMM_WORLD);      /* comm      */
+  /* A column of our h rows, one float apart so that rank s gets h_s
+   * of them starting at its first column */
+  MpiTypeGuard col_t_tmp, col_t;
+  int err = MPI_Type_vector((int) h,         /* count       */
+			    1,               /* blocklength */
+			    (int) ld_in,     /* stride      */
+			    MPI_FLOAT,       /* oldtype     */
+			    &col_t_tmp.type); /* newtype     */
   if (err != MPI_SUCCESS)
-    goto end;
+    return;
+  err = MPI_Type_create_resized(col_t_tmp.type, /* oldtype */
+				0,              /* lb      */
+				sizeof(float),  /* extent  */
+				&col_t.type);   /* newtype */
+  if (err != MPI_SUCCESS)
+    return;
+  err = MPI_Type_commit(&col_t.type);
+  if (err != MPI_SUCCESS)
+    return;
 
-  //printf("Gathered\n");
+  /* Rank s sends its h_s columns as our h rows of h_s floats; h_s
+   * takes at most two values, so two types cover every rank */
+  const size_t h_small = N / (size_t) world_size;
+  MpiTypeGuard rows_t_small, rows_t_large;
+  err = MPI_Type_vector((int) h, (int) h_small, (int) ld_out, MPI_FLOAT,
+			&rows_t_small.type);
+  if (err != MPI_SUCCESS)
+    return;
+  err = MPI_Type_vector((int) h, (int) h_small + 1, (int) ld_out, MPI_FLOAT,
+			&rows_t_large.type);
+  if (err != MPI_SUCCESS)
+    return;
+  err = MPI_Type_commit(&rows_t_small.type);
+  if (err != MPI_SUCCESS)
+    return;
+  err = MPI_Type_commit(&rows_t_large.type);
+  if (err != MPI_SUCCESS)
+    return;
 
-end:
-  delete[] block;
-  delete[] displacements;
-  delete[] displacements_transposed;
-  delete[] counts;
-  MPI_Type_free(&block_t);
-  return;
+  std::vector<int> send_counts(world_size), send_displacements(world_size);
+  std::vector<int> recv_counts(world_size, 1), recv_displacements(world_size);
+  std::vector<MPI_Datatype> send_types(world_size, col_t.type);
+  std::vector<MPI_Datatype> recv_types(world_size);
+  for (int s = 0; s < world_size; ++s)
+  {
+    const size_t c0 = mpiRowBegin(N, s);
+    const size_t h_s = mpiRowBegin(N, s + 1) - c0;
+    send_counts[s] = (int) h_s;
+    send_displacements[s] = (int) (c0 * sizeof(float));
+    recv_types[s] = h_s == h_small ? rows_t_small.type : rows_t_large.type;
+    recv_displacements[s] = (int) (c0 * sizeof(float));
+  }
+
+  err = MPI_Alltoallw(rows, send_counts.data(), send_displacements.data(),
+		      send_types.data(), rows_t, recv_counts.data(),
+		      recv_displacements.data(), recv_types.data(),
+		      MPI_COMM_WORLD);
+  if (err != MPI_SUCCESS)
+    return;
 }
 
 void pc::matTransposeMPIBlockDebug(float *M, float *T, tenno::size N)
@@ -561,9 +2066,7 @@ void pc::matTransposeMPIBlockDebug(float *M, float *T, tenno::size N)
   start = std::chrono::high_resolution_clock::now();
   
   //printf("Transpose\n");
-  for (int i = 0; i < (int) (block_side); ++i)
-    for (int j = i; j < (int) (block_side); ++j)
-        std::swap(block[block_side*i + j], block[j*block_side + i]);
+  pc::matTransposeInPlace(block, (tenno::size) block_side);
 
   end = std::chrono::high_resolution_clock::now();
   transpose = end - start;
@@ -96,11 +96,60 @@ int main(int argc, char** argv)
       for (unsigned long i = 0; i < num_iterations; ++i)
 	pc::matTransposeMPIBlock(mat1, mat2, N);
     }
+    else if (strcmp(func, "A2A") == 0 || strcmp(func, "A2AW") == 0)
+    {
+      /* Our rows of M[i][j] = i * N + j */
+      const size_t r0 = pc::mpiRowBegin(N, pc::world_rank);
+      const size_t r1 = pc::mpiRowBegin(N, pc::world_rank + 1);
+      float *rows = new float[(r1 - r0) * N];
+      float *rows_t = new float[(r1 - r0) * N];
+      for (size_t i = r0; i < r1; ++i)
+	for (size_t j = 0; j < N; ++j)
+	  rows[(i - r0) * N + j] = float(i * N + j);
+      auto transpose = strcmp(func, "A2AW") == 0 ? pc::matTransposeMPIAlltoallw
+				       : pc::matTransposeMPIAlltoall;
+      for (unsigned long i = 0; i < num_iterations; ++i)
+	transpose(rows, rows_t, N, N, N);
+      delete[] rows;
+      delete[] rows_t;
+    }
     else if (strcmp(func, "Sym") == 0)
     {
       for (unsigned long i = 0; i < num_iterations; ++i)
 	pc::checkSymMPI(mat1, N);
     }
+    else if (strcmp(func, "SymSig") == 0)
+    {
+      /* Our rows of the symmetric M[i][j] = i + j */
+      const size_t r0 = pc::mpiRowBegin(N, pc::world_rank);
+      const size_t r1 = pc::mpiRowBegin(N, pc::world_rank + 1);
+      float *rows = new float[(r1 - r0) * N];
+      for (size_t i = r0; i < r1; ++i)
+	for (size_t j = 0; j < N; ++j)
+	  rows[(i - r0) * N + j] = float(i + j);
+      for (unsigned long i = 0; i < num_iterations; ++i)
+	pc::checkSymMPISignature(rows, N, N);
+      delete[] rows;
+    }
+    else if (strcmp(func, "SymBlk") == 0 || strcmp(func, "SymBlkC") == 0)
+    {
+      /* Our block of the symmetric M[i][j] = i * j + i + j, the
+       * C variant aborts early in chunks of 64 columns */
+      const int q = pc::mpiGridSide();
+      const bool owner = pc::world_rank < q * q;
+      const size_t r0 = pc::mpiBlockBegin(N, pc::world_rank / q);
+      const size_t c0 = pc::mpiBlockBegin(N, pc::world_rank % q);
+      const size_t h = owner ? pc::mpiBlockBegin(N, pc::world_rank / q + 1) - r0 : 0;
+      const size_t w = owner ? pc::mpiBlockBegin(N, pc::world_rank % q + 1) - c0 : 0;
+      float *block = new float[h * w];
+      for (size_t i = 0; i < h; ++i)
+	for (size_t j = 0; j < w; ++j)
+	  block[i * w + j] = float((r0 + i) * (c0 + j) + (r0 + i) + (c0 + j));
+      const size_t chunk = strcmp(func, "SymBlkC") == 0 ? 64 : 0;
+      for (unsigned long i = 0; i < num_iterations; ++i)
+	pc::checkSymMPIBlocks(block, N, w, chunk);
+      delete[] block;
+    }
     else {
       fprintf(stdout, "WORKER %d: No function detected\n", pc::world_rank);
     }
@@ -26,7 +26,12 @@
 
 #include <pc/check_symm.hpp>
 #include <tenno/ranges.hpp>
+#include <pc/simd.hpp>
 #include <valfuzz/valfuzz.hpp>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
 #include <mpi.h>
 #include <pc/benchmarks.hpp>  /* contains definition of matrices and world_rank */
 
@@ -82,6 +87,238 @@ TEST(check_sym_columns_test, "checkSymColumns")
     ASSERT(pc::checkSymColumns(M, N) == true);
 }
 
+TEST(check_sym_matrix_test, "checkSym pc::Matrix")
+{
+    tenno::size N = 37;
+    pc::Matrix M(N);
+    for (auto i : tenno::range(N))
+        for (auto j : tenno::range(N))
+            M[i][j] = valfuzz::get_random<float>();
+    M[0][N-1] = M[N-1][0] + 1.0f;
+
+    ASSERT(pc::checkSym(M) == false);
+    ASSERT(pc::checkSymColumns(M) == false);
+
+    for (auto i : tenno::range(N))
+        for (auto j : tenno::range(i, N))
+            M[i][j] = M[j][i];
+
+    ASSERT(pc::checkSym(M) == true);
+    ASSERT(pc::checkSymColumns(M) == true);
+
+    pc::Matrix R(4, 5);
+    ASSERT(pc::checkSym(R) == false);
+}
+
+TEST(check_sym_pitch_test, "checkSym padded pitch")
+{
+    tenno::size N = 37;
+    tenno::size ld = pc::paddedPitch(N);
+    float *M = new float[N*ld];
+    for (size_t i = 0; i < N*ld; ++i)
+        M[i] = valfuzz::get_random<float>();
+    M[1] = M[ld] + 1.0f;
+
+    ASSERT(pc::checkSym(M, N, ld) == false);
+    ASSERT(pc::checkSymColumns(M, N, ld) == false);
+
+    /* The padding is not part of the matrix */
+    for (auto i : tenno::range(N))
+        for (auto j : tenno::range(i, N))
+            M[i*ld + j] = M[j*ld + i];
+
+    ASSERT(pc::checkSym(M, N, ld) == true);
+    ASSERT(pc::checkSymColumns(M, N, ld) == true);
+    ASSERT(pc::checkSym(M, N, N - 1) == false);
+    delete[] M;
+}
+
+TEST(check_sym_intrinsic_test, "checkSymIntrinsic")
+{
+    const pc::SimdLevel native = pc::simdLevel();
+    for (pc::SimdLevel level : {pc::SimdLevel::SSE, pc::SimdLevel::AVX2,
+                                pc::SimdLevel::AVX512})
+    {
+        pc::setSimdLevel(level);
+        /* Whole tiles only, and a tail of columns at every width */
+        for (tenno::size N : {64, 37, 3})
+        {
+            const tenno::size ld = N + 5;
+            pc::Matrix P(N, pc::Padding::Auto);
+            std::vector<float> M(N*ld);
+            std::vector<float *> rows(N);
+            for (auto i : tenno::range(N))
+                rows[i] = M.data() + i*ld;
+            for (auto i : tenno::range(N))
+                for (auto j : tenno::range(i, N))
+                    P[i][j] = P[j][i] = rows[i][j] = rows[j][i] =
+                        valfuzz::get_random<float>();
+
+            ASSERT(pc::checkSymIntrinsic(rows.data(), N) == true);
+            ASSERT(pc::checkSymIntrinsic(M.data(), N, ld) == true);
+            ASSERT(pc::checkSymIntrinsic(P) == true);
+            ASSERT(pc::checkSymIntrinsic(M.data(), N, N - 1) == false);
+
+            /* A mismatch in the first tile, then in the tail */
+            for (auto ij : {std::pair<tenno::size, tenno::size>{0, 1},
+                            {1, N - 1}})
+            {
+                const float old = rows[ij.first][ij.second];
+                rows[ij.first][ij.second] += 1.0f;
+                ASSERT(pc::checkSymIntrinsic(rows.data(), N) == false);
+                ASSERT(pc::checkSymIntrinsic(M.data(), N, ld) == false);
+                rows[ij.first][ij.second] = old;
+            }
+
+#ifndef __FAST_MATH__ /* NaN compares are folded away */
+            P[N-1][N-1] = NAN;
+            ASSERT(pc::checkSymIntrinsic(P) == pc::checkSym(P));
+#endif
+        }
+    }
+    pc::setSimdLevel(native);
+}
+
+TEST(check_sym_signature_test, "checkSymSignature")
+{
+    const pc::SimdLevel native = pc::simdLevel();
+    for (pc::SimdLevel level : {pc::SimdLevel::SSE, pc::SimdLevel::AVX2})
+    {
+        pc::setSimdLevel(level);
+        for (tenno::size N : {64, 37, 3})
+        {
+            const tenno::size ld = N + 3;
+            std::vector<float> M(N*ld);
+            std::vector<float *> rows(N);
+            for (auto i : tenno::range(N))
+                rows[i] = M.data() + i*ld;
+            for (auto i : tenno::range(N))
+                for (auto j : tenno::range(i, N))
+                    rows[i][j] = rows[j][i] = valfuzz::get_random<float>();
+
+            ASSERT(pc::checkSymSignature(rows.data(), N) == true);
+            ASSERT(pc::checkSymSignature(M.data(), N, ld, false) == true);
+
+            /* -0 equals +0 */
+            rows[0][N-1] = 0.0f;
+            rows[N-1][0] = -0.0f;
+            ASSERT(pc::checkSymSignature(M.data(), N, ld) == true);
+
+            /* Swapping two elements of a row keeps its sum of values */
+            std::swap(rows[1][0], rows[1][N-1]);
+            if (rows[1][0] != rows[1][N-1])
+                ASSERT(pc::checkSymSignature(M.data(), N, ld, false) == false);
+            std::swap(rows[1][0], rows[1][N-1]);
+
+#ifndef __FAST_MATH__
+            rows[N-1][N-1] = NAN;
+            ASSERT(pc::checkSymSignature(rows.data(), N) == false);
+#endif
+        }
+    }
+    pc::setSimdLevel(native);
+}
+
+TEST(check_sym_omp_test, "checkSymOMP")
+{
+    for (auto schedule : {pc::OmpSchedule::Static, pc::OmpSchedule::Dynamic,
+                          pc::OmpSchedule::Guided})
+        for (int threads : {1, 3})
+            /* Blocks cut by the end of the matrix, and fewer than one */
+            for (tenno::size N : {200, 128, 3})
+            {
+                const pc::OmpOptions opts{schedule, 0, 1, threads};
+                const tenno::size ld = N + 1;
+                std::vector<float> M(N*ld);
+                std::vector<float *> rows(N);
+                for (auto i : tenno::range(N))
+                    rows[i] = M.data() + i*ld;
+                for (auto i : tenno::range(N))
+                    for (auto j : tenno::range(i, N))
+                        rows[i][j] = rows[j][i] = valfuzz::get_random<float>();
+
+                ASSERT(pc::checkSymOMP(rows.data(), N, opts) == true);
+                ASSERT(pc::checkSymOMP(M.data(), N, ld, opts) == true);
+                ASSERT(pc::checkSymOMP(M.data(), N, N - 1, opts) == false);
+
+                /* The first block, one off the diagonal, the last one */
+                for (auto ij : {std::pair<tenno::size, tenno::size>{0, 1},
+                                {N / 2, N - 1}, {N - 2, N - 1}})
+                {
+                    const float old = rows[ij.first][ij.second];
+                    rows[ij.first][ij.second] += 1.0f;
+                    ASSERT(pc::checkSymOMP(rows.data(), N, opts) == false);
+                    ASSERT(pc::checkSymOMP(M.data(), N, ld, opts) == false);
+                    rows[ij.first][ij.second] = old;
+                }
+            }
+}
+
+TEST(check_sym_sampled_test, "checkSymSampled")
+{
+    const tenno::size W = pc::simdWidth(pc::simdLevel());
+    for (tenno::size N : {256, 37, 3})
+    {
+        const tenno::size ld = N + 7;
+        std::vector<float> M(N*ld);
+        std::vector<float *> rows(N);
+        for (auto i : tenno::range(N))
+            rows[i] = M.data() + i*ld;
+        for (auto &x : M)
+            x = valfuzz::get_random<float>();
+
+        /* Every tile of a random matrix differs from its mirror */
+        tenno::size taken = 1;
+        ASSERT(pc::checkSymSampled(M.data(), N, ld, 1000, &taken) == false);
+        ASSERT(taken == (N >= W ? W*W : 0));
+
+        for (auto i : tenno::range(N))
+            for (auto j : tenno::range(i, N))
+                rows[i][j] = rows[j][i];
+
+        ASSERT(pc::checkSymSampled(rows.data(), N, 1000, &taken) == true);
+        ASSERT(taken == (N >= W ? (1000 + W*W - 1) / (W*W) * W*W : 0));
+        ASSERT(pc::checkSymSampled(M.data(), N, ld, 0, &taken) == true);
+        ASSERT(taken == 0);
+
+        /* A single pair the samples are unlikely to hit */
+        rows[N-2][N-1] += 1.0f;
+        ASSERT(pc::checkSymSampled(M.data(), N, ld, 16) == false);
+        ASSERT(pc::checkSymSampled(rows.data(), N, 16) == false);
+    }
+}
+
+TEST(check_sym_fixed_test, "checkSymFixed")
+{
+    const pc::SimdLevel native = pc::simdLevel();
+    for (pc::SimdLevel level : {pc::SimdLevel::SSE, pc::SimdLevel::AVX2,
+                                pc::SimdLevel::AVX512})
+    {
+        pc::setSimdLevel(level);
+        for (tenno::size N : {4, 8, 16, 32, 64, 5, 12, 128})
+        {
+            std::vector<float> M(N*N);
+            for (auto i : tenno::range(N))
+                for (auto j : tenno::range(i, N))
+                    M[i*N + j] = M[j*N + i] = valfuzz::get_random<float>();
+
+            ASSERT(pc::checkSymFixed(M.data(), N) == true);
+            if (N == 32)
+                ASSERT(pc::checkSymFixed<32>(M.data()) == true);
+
+            /* One mismatch in the last tile, then a NaN on the diagonal */
+            M[(N-2)*N + N-1] = M[(N-1)*N + N-2] + 1.0f;
+            ASSERT(pc::checkSymFixed(M.data(), N) == false);
+#ifndef __FAST_MATH__
+            M[(N-2)*N + N-1] = M[(N-1)*N + N-2];
+            M[0] = NAN;
+            ASSERT(pc::checkSymFixed(M.data(), N) == false);
+#endif
+        }
+    }
+    pc::setSimdLevel(native);
+}
+
 TEST(check_sym_mpi_test, "checkSymMPI")
 {
     if (pc::world_rank != 0)
@@ -132,3 +369,122 @@ TEST(check_sym_mpi_test, "checkSymMPI")
     delete[] M_cyclic;
     return;
 }
+
+TEST(check_sym_mpi_uneven_test, "checkSymMPI uneven")
+{
+    if (pc::world_rank != 0)
+      ASSERT(false);
+
+    /* Prime, so no process grid splits it evenly */
+    constexpr tenno::size N = 37;
+    std::vector<float> M(N*N);
+    for (size_t i = 0; i < N; ++i)
+      for (size_t j = 0; j < N; ++j)
+	M[i*N + j] = float(i + j);
+
+    char message[10] = "Sym\0";
+    int err = MPI_Bcast(&message, 10, MPI_CHAR, 0, MPI_COMM_WORLD);
+    if (err != MPI_SUCCESS)
+      return;
+
+    size_t n = N;
+    err = MPI_Bcast(&n, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+    if (err != MPI_SUCCESS)
+      return;
+
+    long unsigned int num_iterations = 2;
+    err = MPI_Bcast(&num_iterations, 1,
+                     MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+    if (err != MPI_SUCCESS)
+      return;
+
+    ASSERT(pc::checkSymMPI(M.data(), N) == true);
+    /* In the last block of the grid */
+    M[(N-1)*N + N-2] += 1.0f;
+    ASSERT(pc::checkSymMPI(M.data(), N) == false);
+}
+
+TEST(check_sym_mpi_signature_test, "checkSymMPISignature")
+{
+    if (pc::world_rank != 0)
+      ASSERT(false);
+
+    /* Not a multiple of the ranks, the workers fill their rows with
+     * M[i][j] = i + j as well */
+    constexpr tenno::size N = 37;
+    const tenno::size rows = pc::mpiRowBegin(N, 1);
+    float *M = new float[rows*N];
+    for (size_t i = 0; i < rows; ++i)
+      for (size_t j = 0; j < N; ++j)
+	M[i*N + j] = float(i + j);
+
+    char message[10] = "SymSig\0";
+    int err = MPI_Bcast(&message, 10, MPI_CHAR, 0, MPI_COMM_WORLD);
+    if (err != MPI_SUCCESS)
+      return;
+
+    size_t n = N;
+    err = MPI_Bcast(&n, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+    if (err != MPI_SUCCESS)
+      return;
+
+    long unsigned int num_iterations = 3;
+    err = MPI_Bcast(&num_iterations, 1,
+                     MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+    if (err != MPI_SUCCESS)
+      return;
+
+    ASSERT(pc::checkSymMPISignature(M, N, N) == true);
+    /* Column N-1 is hashed on the last rank */
+    M[N-1] += 1.0f;
+    ASSERT(pc::checkSymMPISignature(M, N, N) == false);
+    M[N-1] -= 1.0f;
+    ASSERT(pc::checkSymMPISignature(M, N, N - 1) == false);
+
+    delete[] M;
+}
+
+TEST(check_sym_mpi_blocks_test, "checkSymMPIBlocks")
+{
+    if (pc::world_rank != 0)
+      ASSERT(false);
+
+    /* The workers fill their blocks with M[i][j] = i * j + i + j;
+     * rank 0 owns the top left one, on the diagonal. Blocks of 150
+     * and 151 take three chunks of 64 */
+    constexpr tenno::size N = 301;
+    const tenno::size h = pc::mpiBlockBegin(N, 1);
+    const tenno::size ld = h + 3;
+    float *M = new float[h*ld];
+    for (size_t i = 0; i < h; ++i)
+      for (size_t j = 0; j < h; ++j)
+	M[i*ld + j] = float(i * j + i + j);
+
+    for (const char *func : {"SymBlk", "SymBlkC"})
+    {
+      char message[10] = {};
+      strcpy(message, func);
+      int err = MPI_Bcast(&message, 10, MPI_CHAR, 0, MPI_COMM_WORLD);
+      if (err != MPI_SUCCESS)
+        return;
+
+      size_t n = N;
+      err = MPI_Bcast(&n, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      if (err != MPI_SUCCESS)
+        return;
+
+      long unsigned int num_iterations = 2;
+      err = MPI_Bcast(&num_iterations, 1,
+                       MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+      if (err != MPI_SUCCESS)
+        return;
+
+      const tenno::size chunk = func[6] == 'C' ? 64 : 0;
+      ASSERT(pc::checkSymMPIBlocks(M, N, ld, chunk) == true);
+      M[1] += 1.0f;
+      ASSERT(pc::checkSymMPIBlocks(M, N, ld, chunk) == false);
+      M[1] -= 1.0f;
+    }
+
+    delete[] M;
+}
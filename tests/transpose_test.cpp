@@ -25,11 +25,22 @@
  */
 
 #include <pc/transpose.hpp>
+#include <pc/simd.hpp>
+#include <pc/numa.hpp>
+#include <pc/arena.hpp>
 #include <mpi.h>
 #include <pc/benchmarks.hpp>  /* contains definition of matrices and world_rank */
 #include <tenno/ranges.hpp>
 #include <valfuzz/valfuzz.hpp>
 
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
 TEST(transpose_matrix_test, "matTranspose")
 {
     tenno::size N = 64;
@@ -240,6 +251,700 @@ TEST(transpose_matrix_intrinsic_cyclic_test, "matTransposeIntrinsicCyclic")
     return;
 }
 
+TEST(transpose_matrix_intrinsic_levels_test, "matTransposeIntrinsic all levels")
+{
+    /* Guard after the output to catch out of bounds stores */
+    constexpr tenno::size guard = 32;
+    constexpr float sentinel = -1.0f;
+
+    const pc::SimdLevel native = pc::simdLevel();
+    for (auto level : {pc::SimdLevel::SSE, pc::SimdLevel::AVX2,
+                       pc::SimdLevel::AVX512})
+    {
+        pc::setSimdLevel(level);
+        for (tenno::size N : {64, 48, 100, 1000, 37, 3, 1})
+        {
+            float **M = new float *[N];
+            float **T = new float *[N];
+            float *M_cyclic = new float[N*N];
+            float *T_cyclic = new float[N*N + guard];
+            for (auto i : tenno::range(N))
+            {
+                M[i] = new float[N];
+                T[i] = new float[N];
+                for (auto j : tenno::range(N))
+                {
+                    M[i][j] = float(i*N + j);
+                    M_cyclic[i*N + j] = float(i*N + j);
+                }
+            }
+            for (size_t i = N*N; i < N*N + guard; ++i)
+                T_cyclic[i] = sentinel;
+
+            pc::matTransposeIntrinsic(M, T, N);
+            pc::matTransposeIntrinsicCyclic(M_cyclic, T_cyclic, N);
+
+            for (auto i : tenno::range(N))
+            {
+                for (auto j : tenno::range(N))
+                {
+                    ASSERT(M[i][j] == T[j][i]);
+                    ASSERT(M_cyclic[i*N + j] == T_cyclic[j*N + i]);
+                }
+            }
+            for (size_t i = N*N; i < N*N + guard; ++i)
+                ASSERT(T_cyclic[i] == sentinel);
+
+            for (auto i : tenno::range(N))
+            {
+                delete[] M[i];
+                delete[] T[i];
+            }
+            delete[] M;
+            delete[] T;
+            delete[] M_cyclic;
+            delete[] T_cyclic;
+        }
+    }
+    pc::setSimdLevel(native);
+}
+
+TEST(transpose_matrix_prefetch_test, "matTransposePrefetch")
+{
+    for (tenno::size N : {100, 64, 3})
+    {
+        float **M = new float *[N];
+        float **T = new float *[N];
+        for (auto i : tenno::range(N))
+        {
+            M[i] = new float[N];
+            T[i] = new float[N];
+            for (auto j : tenno::range(N))
+                M[i][j] = valfuzz::get_random<float>();
+        }
+
+        for (tenno::size distance : {0, 1, 16, 1000})
+        {
+            pc::matTransposePrefetch(M, T, N, distance);
+            for (auto i : tenno::range(N))
+                for (auto j : tenno::range(N))
+                    ASSERT(M[i][j] == T[j][i]);
+
+            pc::matTransposeIntrinsicPrefetch(M, T, N, distance);
+            for (auto i : tenno::range(N))
+                for (auto j : tenno::range(N))
+                    ASSERT(M[i][j] == T[j][i]);
+        }
+
+        for (auto i : tenno::range(N))
+        {
+            delete[] M[i];
+            delete[] T[i];
+        }
+        delete[] M;
+        delete[] T;
+    }
+}
+
+TEST(transpose_matrix_strided_test, "matTransposeStrided")
+{
+    /* Sub-blocks of a padded buffer, the padding must be untouched */
+    constexpr tenno::size lda = 300;
+    constexpr tenno::size ldb = 310;
+    constexpr float sentinel = -1.0f;
+    float *A = new float[lda*lda];
+    float *B = new float[ldb*ldb];
+    for (size_t i = 0; i < lda*lda; ++i)
+        A[i] = float(i);
+
+    const tenno::size shapes[][2] = {{64, 64}, {100, 37}, {37, 100},
+                                     {1, 250}, {250, 1}, {300, 300}};
+    for (const auto &shape : shapes)
+    {
+        const tenno::size rows = shape[0];
+        const tenno::size cols = shape[1];
+        for (size_t i = 0; i < ldb*ldb; ++i)
+            B[i] = sentinel;
+
+        pc::matTransposeStrided(A, rows, cols, lda, B, ldb);
+
+        for (auto i : tenno::range(ldb))
+            for (auto j : tenno::range(ldb))
+            {
+                if (i < cols && j < rows)
+                    ASSERT(B[i*ldb + j] == A[j*lda + i]);
+                else
+                    ASSERT(B[i*ldb + j] == sentinel);
+            }
+    }
+
+    delete[] A;
+    delete[] B;
+}
+
+template <typename T>
+static void check_strided_type(T (*make)(size_t))
+{
+    const pc::SimdLevel native = pc::simdLevel();
+    for (pc::SimdLevel level : {pc::SimdLevel::SSE, pc::SimdLevel::AVX2,
+                                pc::SimdLevel::AVX512})
+    {
+        pc::setSimdLevel(level);
+        for (auto shape : {std::pair<tenno::size, tenno::size>{64, 64},
+                           {37, 100}, {16, 33}, {130, 17}, {1, 5}})
+        {
+            const tenno::size rows = shape.first, cols = shape.second;
+            const tenno::size lda = cols + 3, ldb = rows + 5;
+            std::vector<T> A(rows * lda), B(cols * ldb, make(0));
+            for (size_t i = 0; i < A.size(); ++i)
+                A[i] = make(i + 1);
+
+            pc::matTransposeStrided(A.data(), rows, cols, lda, B.data(), ldb);
+            for (auto i : tenno::range(rows))
+                for (auto j : tenno::range(cols))
+                    ASSERT(A[i*lda + j] == B[j*ldb + i]);
+            for (auto j : tenno::range(cols))
+                for (auto i : tenno::range(rows, ldb))
+                    ASSERT(B[j*ldb + i] == make(0));
+        }
+    }
+    pc::setSimdLevel(native);
+}
+
+template <typename T>
+static void check_conj_type()
+{
+    const pc::SimdLevel native = pc::simdLevel();
+    for (pc::SimdLevel level : {pc::SimdLevel::SSE, pc::SimdLevel::AVX2,
+                                pc::SimdLevel::AVX512})
+    {
+        pc::setSimdLevel(level);
+        const tenno::size rows = 37, cols = 70;
+        std::vector<std::complex<T>> A(rows * cols), B(cols * rows);
+        for (size_t i = 0; i < A.size(); ++i)
+            A[i] = {T(i), -T(i) / 2};
+
+        pc::matTransposeConj(A.data(), rows, cols, cols, B.data(), rows);
+        for (auto i : tenno::range(rows))
+            for (auto j : tenno::range(cols))
+                ASSERT(std::conj(A[i*cols + j]) == B[j*rows + i]);
+    }
+    pc::setSimdLevel(native);
+}
+
+TEST(transpose_matrix_fixed_test, "matTransposeFixed")
+{
+    const pc::SimdLevel native = pc::simdLevel();
+    for (pc::SimdLevel level : {pc::SimdLevel::SSE, pc::SimdLevel::AVX2,
+                                pc::SimdLevel::AVX512})
+    {
+        pc::setSimdLevel(level);
+        /* The instances and the fallback on either side of them */
+        for (tenno::size N : {4, 8, 16, 32, 64, 5, 12, 128})
+        {
+            std::vector<float> M(N*N), T(N*N, 0.0f), F(N*N, 0.0f);
+            for (auto &x : M)
+                x = valfuzz::get_random<float>();
+
+            pc::matTransposeFixed(M.data(), T.data(), N);
+            for (auto i : tenno::range(N))
+                for (auto j : tenno::range(N))
+                    ASSERT(M[i*N + j] == T[j*N + i]);
+            if (N == 16)
+            {
+                pc::matTransposeFixed<16>(M.data(), F.data());
+                ASSERT(F == T);
+            }
+        }
+    }
+    pc::setSimdLevel(native);
+}
+
+TEST(transpose_matrix_element_types_test, "matTransposeStrided element types")
+{
+    check_strided_type<int8_t>([](size_t i) { return int8_t(i * 7); });
+    check_strided_type<uint16_t>([](size_t i) { return uint16_t(i * 13); });
+    check_strided_type<int32_t>([](size_t i) { return int32_t(i) - 1000; });
+    check_strided_type<double>([](size_t i) { return double(i) / 3; });
+    check_strided_type<uint64_t>([](size_t i) { return uint64_t(i) << 33; });
+    check_strided_type<std::complex<float>>(
+        [](size_t i) { return std::complex<float>(float(i), -float(i)); });
+    check_strided_type<std::complex<double>>(
+        [](size_t i) { return std::complex<double>(double(i), 0.5); });
+
+    check_conj_type<float>();
+    check_conj_type<double>();
+}
+
+TEST(transpose_matrix_in_place_test, "matTransposeInPlace")
+{
+    const pc::SimdLevel native = pc::simdLevel();
+    for (auto level : {pc::SimdLevel::SSE, pc::SimdLevel::AVX2,
+                       pc::SimdLevel::AVX512})
+    {
+        pc::setSimdLevel(level);
+        for (tenno::size N : {64, 100, 37, 3, 1})
+        {
+            float **M = new float *[N];
+            float *M_cyclic = new float[N*N];
+            for (auto i : tenno::range(N))
+            {
+                M[i] = new float[N];
+                for (auto j : tenno::range(N))
+                {
+                    M[i][j] = float(i*N + j);
+                    M_cyclic[i*N + j] = float(i*N + j);
+                }
+            }
+
+            pc::matTransposeInPlace(M, N);
+            pc::matTransposeInPlace(M_cyclic, N);
+
+            for (auto i : tenno::range(N))
+            {
+                for (auto j : tenno::range(N))
+                {
+                    ASSERT(M[j][i] == float(i*N + j));
+                    ASSERT(M_cyclic[j*N + i] == float(i*N + j));
+                }
+            }
+
+            for (auto i : tenno::range(N))
+                delete[] M[i];
+            delete[] M;
+            delete[] M_cyclic;
+        }
+    }
+    pc::setSimdLevel(native);
+}
+
+TEST(transpose_matrix_in_place_rectangular_test, "matTransposeInPlace rectangular")
+{
+    /* Thin shapes, short and tall ones whose short side does not
+     * divide the long one, coprime ones, gcd 12 below the run
+     * threshold and gcd 32 and 1000 above it */
+    const tenno::size shapes[][2] = {{3, 5}, {64, 16}, {100, 37},
+                                     {1, 7}, {7, 1}, {50, 50}, {300, 257},
+                                     {12, 8}, {6, 4096}, {3, 100003},
+                                     {100003, 3}, {16, 4099}, {120, 84},
+                                     {1001, 999}, {96, 64}, {3000, 2000}};
+    for (const auto &shape : shapes)
+    {
+        const tenno::size rows = shape[0];
+        const tenno::size cols = shape[1];
+        float *M = new float[rows*cols];
+        for (size_t i = 0; i < rows*cols; ++i)
+            M[i] = float(i);
+
+        pc::matTransposeInPlace(M, rows, cols);
+
+        /* M is now cols x rows */
+        for (auto i : tenno::range(rows))
+            for (auto j : tenno::range(cols))
+                ASSERT(M[j*rows + i] == float(i*cols + j));
+
+        delete[] M;
+    }
+}
+
+TEST(transpose_matrix_recursive_test, "matTransposeRecursive")
+{
+    /* Also sizes that do not split evenly into leaves */
+    for (tenno::size N : {200, 37, 3})
+    {
+        float **M = new float *[N];
+        float **T = new float *[N];
+        for (auto i : tenno::range(N))
+        {
+            M[i] = new float[N];
+            T[i] = new float[N];
+            for (auto j : tenno::range(N))
+            {
+                M[i][j] = valfuzz::get_random<float>();
+            }
+        }
+
+        pc::matTransposeRecursive(M, T, N);
+
+        for (auto i : tenno::range(N))
+        {
+            for (auto j : tenno::range(N))
+            {
+                ASSERT(M[i][j] == T[j][i]);
+            }
+        }
+
+        for (auto i : tenno::range(N))
+        {
+            delete[] M[i];
+            delete[] T[i];
+        }
+        delete[] M;
+        delete[] T;
+    }
+}
+
+TEST(transpose_matrix_recursive_cyclic_test, "matTransposeRecursiveCyclic")
+{
+    for (tenno::size N : {64, 300, 37})
+    {
+        float *M_cyclic = new float[N*N];
+        float *T_cyclic = new float[N*N];
+        for (size_t i = 0; i < N*N; ++i)
+            M_cyclic[i] = float(i);
+
+        pc::matTransposeRecursiveCyclic(M_cyclic, T_cyclic, N);
+
+        for (auto i : tenno::range(N))
+            for (auto j : tenno::range(N))
+                ASSERT(M_cyclic[i*N + j] == T_cyclic[j*N + i]);
+
+        delete[] M_cyclic;
+        delete[] T_cyclic;
+    }
+}
+
+TEST(transpose_matrix_omp_test, "matTranspose OMP kernels")
+{
+    const pc::OmpOptions options[] = {
+        {},
+        {pc::OmpSchedule::Dynamic, 1, 2, 3},
+        {pc::OmpSchedule::Guided, 4, 1, 2},
+        {pc::OmpSchedule::Static, 3, 2, 0},
+    };
+
+    for (tenno::size N : {100, 64, 37, 1})
+    {
+        float *M = new float[N*N];
+        float *T = new float[N*N];
+        float **M_rows = new float *[N];
+        float **T_rows = new float *[N];
+        for (auto i : tenno::range(N))
+        {
+            M_rows[i] = M + i*N;
+            T_rows[i] = T + i*N;
+        }
+        for (size_t i = 0; i < N*N; ++i)
+            M[i] = float(i);
+
+        for (const pc::OmpOptions &opts : options)
+        {
+            for (int kernel = 0; kernel < 4; ++kernel)
+            {
+                std::fill(T, T + N*N, -1.0f);
+                switch (kernel)
+                {
+                case 0:
+                    pc::matTransposeCyclicOMP(M, T, N, opts);
+                    break;
+                case 1:
+                    pc::matTransposeIntrinsicOMP(M_rows, T_rows, N, opts);
+                    break;
+                case 2:
+                    pc::matTransposeIntrinsicCyclicOMP(M, T, N, opts);
+                    break;
+                default:
+                    pc::matTransposeStridedOMP(M, N, N, N, T, N, opts);
+                    break;
+                }
+
+                for (auto i : tenno::range(N))
+                    for (auto j : tenno::range(N))
+                        ASSERT(M[i*N + j] == T[j*N + i]);
+            }
+        }
+
+        delete[] M;
+        delete[] T;
+        delete[] M_rows;
+        delete[] T_rows;
+    }
+}
+
+TEST(transpose_matrix_batch_test, "matTransposeBatch")
+{
+    const pc::SimdLevel native = pc::simdLevel();
+    for (pc::SimdLevel level : {pc::SimdLevel::SSE, pc::SimdLevel::AVX2,
+                                pc::SimdLevel::AVX512})
+    {
+        pc::setSimdLevel(level);
+        /* Fixed instances, flat tiles of each width and a size
+         * with edges; an odd count leaves an 8x8 without a pair */
+        for (tenno::size N : {4, 8, 32, 12, 20, 24, 48, 6})
+        {
+            const tenno::size count = 37, size = N*N;
+            std::vector<float> M(count*size), T(count*size, 0.0f),
+                P(count*size, 0.0f), R(count*size, 0.0f);
+            for (auto &x : M)
+                x = valfuzz::get_random<float>();
+
+            /* The pointer version gets the matrices in reverse order */
+            std::vector<const float *> src(count);
+            std::vector<float *> dst(count);
+            for (auto k : tenno::range(count))
+            {
+                src[k] = M.data() + (count - 1 - k)*size;
+                dst[k] = P.data() + (count - 1 - k)*size;
+            }
+
+            pc::OmpOptions opts;
+            opts.schedule = pc::OmpSchedule::Dynamic;
+            pc::matTransposeBatch(M.data(), T.data(), N, count);
+            pc::matTransposeBatch(src.data(), dst.data(), N, count, opts);
+            for (auto k : tenno::range(count))
+                for (auto i : tenno::range(N))
+                    for (auto j : tenno::range(N))
+                        ASSERT(M[k*size + i*N + j] == T[k*size + j*N + i]);
+            ASSERT(P == T);
+
+            /* Same as one matrix at a time */
+            for (auto k : tenno::range(count))
+                pc::matTransposeFixed(M.data() + k*size, R.data() + k*size, N);
+            ASSERT(R == T);
+        }
+    }
+    pc::setSimdLevel(native);
+}
+
+TEST(transpose_matrix_numa_test, "matTransposeIntrinsicCyclicOMP numa placement")
+{
+    for (pc::NumaPlacement placement : {pc::NumaPlacement::Naive,
+                                        pc::NumaPlacement::Local,
+                                        pc::NumaPlacement::Interleave})
+    {
+        tenno::size N = 300;
+        float *M = pc::numaAlloc(N, N, placement, 3,
+                                 pc::NumaPartition::Rows);
+        float *T = pc::numaAlloc(N, N, placement, 3,
+                                 pc::NumaPartition::Columns);
+        ASSERT(M != nullptr && T != nullptr);
+        if (M == nullptr || T == nullptr)
+            return;
+
+        for (size_t i = 0; i < N*N; ++i)
+            ASSERT(M[i] == 0.0f && T[i] == 0.0f);
+        for (size_t i = 0; i < N*N; ++i)
+            M[i] = float(i);
+
+        pc::matTransposeIntrinsicCyclicOMP(M, T, N, {pc::OmpSchedule::Static,
+                                                     0, 1, 3});
+
+        for (auto i : tenno::range(N))
+            for (auto j : tenno::range(N))
+                ASSERT(M[i*N + j] == T[j*N + i]);
+
+        pc::numaFree(M, N, N);
+        pc::numaFree(T, N, N);
+    }
+}
+
+TEST(transpose_matrix_stream_test, "matTransposeIntrinsicCyclic streaming stores")
+{
+    const pc::SimdLevel native = pc::simdLevel();
+    const tenno::size threshold = pc::streamThreshold();
+    pc::setStreamThreshold(0);
+
+    for (pc::SimdLevel level : {pc::SimdLevel::SSE, pc::SimdLevel::AVX2,
+                                pc::SimdLevel::AVX512})
+    {
+        pc::setSimdLevel(level);
+        /* 100 is not a multiple of the tile side and takes the
+         * regular path */
+        for (tenno::size N : {64, 128, 48, 100})
+        {
+            float *M = static_cast<float *>(std::aligned_alloc(64, N*N*sizeof(float)));
+            float *T = static_cast<float *>(std::aligned_alloc(64, N*N*sizeof(float)));
+            for (size_t i = 0; i < N*N; ++i)
+                M[i] = float(i);
+
+            pc::matTransposeIntrinsicCyclic(M, T, N);
+            for (auto i : tenno::range(N))
+                for (auto j : tenno::range(N))
+                    ASSERT(M[i*N + j] == T[j*N + i]);
+
+            std::fill(T, T + N*N, -1.0f);
+            pc::matTransposeIntrinsicCyclicOMP(M, T, N, {pc::OmpSchedule::Dynamic,
+                                                         1, 2, 3});
+            for (auto i : tenno::range(N))
+                for (auto j : tenno::range(N))
+                    ASSERT(M[i*N + j] == T[j*N + i]);
+
+            std::free(M);
+            std::free(T);
+        }
+    }
+
+    pc::setSimdLevel(native);
+    pc::setStreamThreshold(threshold);
+}
+
+TEST(transpose_matrix_type_test, "pc::Matrix layout")
+{
+    for (tenno::size cols : {1, 15, 16, 17, 100})
+    {
+        pc::Matrix M(3, cols);
+        ASSERT(M.rows() == 3 && M.cols() == cols);
+        ASSERT(M.pitch() >= cols && M.pitch() % 16 == 0);
+        for (auto i : tenno::range(M.rows()))
+            ASSERT(reinterpret_cast<uintptr_t>(M[i]) % pc::Matrix::alignment == 0);
+
+        pc::Matrix moved(std::move(M));
+        ASSERT(moved.cols() == cols && M.data() == nullptr);
+    }
+}
+
+TEST(transpose_matrix_type_kernels_test, "matTranspose pc::Matrix")
+{
+    const pc::SimdLevel native = pc::simdLevel();
+    for (tenno::size N : {100, 64, 37, 1})
+    {
+        pc::Matrix M(N);
+        for (auto i : tenno::range(N))
+            for (auto j : tenno::range(N))
+                M[i][j] = float(i*N + j);
+
+        for (int kernel = 0; kernel < 5; ++kernel)
+        {
+            pc::Matrix T(N);
+            if (kernel == 0)
+                pc::matTranspose(M, T);
+            else if (kernel == 1)
+                pc::matTransposeHalf(M, T);
+            else if (kernel == 2)
+                pc::matTransposeColumns(M, T);
+            else if (kernel == 3)
+                pc::matTransposeCyclic(M, T);
+            else
+                pc::matTransposeIntrinsicCyclic(M, T);
+            for (auto i : tenno::range(N))
+                for (auto j : tenno::range(N))
+                    ASSERT(M[i][j] == T[j][i]);
+        }
+    }
+
+    /* Rectangular, with every level of the aligned kernels */
+    for (pc::SimdLevel level : {pc::SimdLevel::SSE, pc::SimdLevel::AVX2,
+                                pc::SimdLevel::AVX512})
+    {
+        pc::setSimdLevel(level);
+        for (auto shape : {std::pair<tenno::size, tenno::size>{64, 48},
+                           {37, 100}, {16, 16}, {3, 1}})
+        {
+            pc::Matrix M(shape.first, shape.second);
+            pc::Matrix T(shape.second, shape.first);
+            for (auto i : tenno::range(M.rows()))
+                for (auto j : tenno::range(M.cols()))
+                    M[i][j] = float(i*M.cols() + j);
+
+            pc::matTransposeIntrinsic(M, T);
+            for (auto i : tenno::range(M.rows()))
+                for (auto j : tenno::range(M.cols()))
+                    ASSERT(M[i][j] == T[j][i]);
+
+            pc::Matrix C(shape.second, shape.first);
+            pc::matTranspose(M, C);
+            for (auto i : tenno::range(M.rows()))
+                for (auto j : tenno::range(M.cols()))
+                    ASSERT(M[i][j] == C[j][i]);
+        }
+    }
+    pc::setSimdLevel(native);
+
+    /* Shape mismatch leaves T untouched */
+    pc::Matrix M(4, 5);
+    pc::Matrix T(4, 5);
+    M[0][1] = 1.0f;
+    pc::matTransposeIntrinsic(M, T);
+    ASSERT(T[1][0] == 0.0f);
+}
+
+TEST(transpose_matrix_arena_test, "matTransposeColumns huge page arena")
+{
+    tenno::size N = 300;
+    pc::Arena arena(2 * N*N * sizeof(float));
+    ASSERT(arena.capacity() % pc::huge_page_size == 0);
+
+    float *M = static_cast<float *>(arena.allocate(N*N * sizeof(float)));
+    float *T = static_cast<float *>(arena.allocate(N*N * sizeof(float)));
+    ASSERT(M != nullptr && T != nullptr);
+    if (M == nullptr || T == nullptr)
+        return;
+    ASSERT(reinterpret_cast<uintptr_t>(T) % 64 == 0);
+    ASSERT(arena.owns(M) && arena.owns(T));
+    ASSERT(arena.allocate(arena.capacity()) == nullptr);
+
+    float **M_rows = new float *[N];
+    float **T_rows = new float *[N];
+    for (auto i : tenno::range(N))
+    {
+        M_rows[i] = M + i*N;
+        T_rows[i] = T + i*N;
+        for (auto j : tenno::range(N))
+            M_rows[i][j] = float(i*N + j);
+    }
+
+    pc::matTransposeColumns(M_rows, T_rows, N);
+    for (auto i : tenno::range(N))
+        for (auto j : tenno::range(N))
+            ASSERT(M_rows[i][j] == T_rows[j][i]);
+
+    /* Releasing the first block frees both */
+    arena.release(M);
+    ASSERT(arena.used() == 0);
+    arena.release(T);
+    ASSERT(arena.used() == 0);
+
+    delete[] M_rows;
+    delete[] T_rows;
+}
+
+TEST(transpose_matrix_padded_test, "matTransposeCyclic padded pitch")
+{
+    for (tenno::size cols : {1, 16, 17, 32, 100, 4096})
+    {
+        const tenno::size ld = pc::paddedPitch(cols);
+        ASSERT(ld >= cols && ld % 16 == 0 && (ld / 16) % 2 == 1);
+    }
+    pc::Matrix P(4, 64, pc::Padding::Auto);
+    ASSERT(P.pitch() == pc::paddedPitch(64));
+
+    const pc::SimdLevel native = pc::simdLevel();
+    for (pc::SimdLevel level : {pc::SimdLevel::SSE, pc::SimdLevel::AVX2,
+                                pc::SimdLevel::AVX512})
+    {
+        pc::setSimdLevel(level);
+        for (tenno::size N : {64, 37, 1})
+        {
+            const tenno::size ldm = pc::paddedPitch(N);
+            const tenno::size ldt = N + 3;
+            float *M = new float[N*ldm];
+            float *T = new float[N*ldt];
+            for (size_t i = 0; i < N*ldm; ++i)
+                M[i] = float(i);
+
+            std::fill(T, T + N*ldt, -1.0f);
+            pc::matTransposeIntrinsicCyclic(M, T, N, ldm, ldt);
+            for (auto i : tenno::range(N))
+            {
+                for (auto j : tenno::range(N))
+                    ASSERT(M[i*ldm + j] == T[j*ldt + i]);
+                for (auto j : tenno::range(N, ldt))
+                    ASSERT(T[i*ldt + j] == -1.0f);
+            }
+
+            std::fill(T, T + N*ldt, -1.0f);
+            pc::matTransposeCyclic(M, T, N, ldm, ldt);
+            for (auto i : tenno::range(N))
+                for (auto j : tenno::range(N))
+                    ASSERT(M[i*ldm + j] == T[j*ldt + i]);
+
+            delete[] M;
+            delete[] T;
+        }
+    }
+    pc::setSimdLevel(native);
+}
+
 TEST(transpose_matrix_mpi_test, "matTransposeMPI")
 {
     if (pc::world_rank != 0)
@@ -369,3 +1074,90 @@ TEST(transpose_matrix_mpi_block_test, "matTransposeMPIBlock")
     delete[] T_cyclic;
     return;
 }
+
+TEST(transpose_matrix_mpi_alltoall_test, "matTransposeMPIAlltoall")
+{
+    if (pc::world_rank != 0)
+      ASSERT(false);
+
+    /* The workers fill their rows with M[i][j] = i * N + j as well,
+     * 37 rows are not split evenly */
+    for (const char *func : {"A2A", "A2AW"})
+      for (const tenno::size N : {64ul, 37ul})
+      {
+	const tenno::size rows = pc::mpiRowBegin(N, 1);
+	const tenno::size ld = N + 3;
+	std::vector<float> M(rows*ld), T(rows*ld);
+	for (size_t i = 0; i < rows; ++i)
+	  for (size_t j = 0; j < N; ++j)
+	    M[i*ld + j] = float(i*N + j);
+
+	char message[10] = {};
+	strcpy(message, func);
+	int err = MPI_Bcast(&message, 10, MPI_CHAR, 0, MPI_COMM_WORLD);
+	if (err != MPI_SUCCESS)
+	  return;
+
+	size_t n = N;
+	err = MPI_Bcast(&n, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+	if (err != MPI_SUCCESS)
+	  return;
+
+	long unsigned int num_iterations = 1;
+	err = MPI_Bcast(&num_iterations, 1,
+			 MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+	if (err != MPI_SUCCESS)
+	  return;
+
+	if (func[3] == 'W')
+	  pc::matTransposeMPIAlltoallw(M.data(), T.data(), N, ld, ld);
+	else
+	  pc::matTransposeMPIAlltoall(M.data(), T.data(), N, ld, ld);
+
+	for (size_t i = 0; i < rows; ++i)
+	  for (size_t j = 0; j < N; ++j)
+	    if (T[i*ld + j] != float(j*N + i))
+	      {
+		ASSERT(false);
+		return;
+	      }
+      }
+}
+
+TEST(transpose_matrix_mpi_block_uneven_test, "matTransposeMPIBlock uneven")
+{
+    if (pc::world_rank != 0)
+      ASSERT(false);
+
+    /* Prime, so no process grid splits it evenly */
+    constexpr tenno::size N = 37;
+    std::vector<float> M(N*N), T(N*N);
+    for (size_t i = 0; i < N*N; ++i)
+	M[i] = float(i);
+
+    char message[10] = "Block\0";
+    int err = MPI_Bcast(&message, 10, MPI_CHAR, 0, MPI_COMM_WORLD);
+    if (err != MPI_SUCCESS)
+      return;
+
+    size_t n = N;
+    err = MPI_Bcast(&n, 1, MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+    if (err != MPI_SUCCESS)
+      return;
+
+    long unsigned int num_iterations = 1;
+    err = MPI_Bcast(&num_iterations, 1,
+                     MPI_UNSIGNED_LONG, 0, MPI_COMM_WORLD);
+    if (err != MPI_SUCCESS)
+      return;
+
+    pc::matTransposeMPIBlock(M.data(), T.data(), N);
+
+    for (auto i : tenno::range(N))
+        for (auto j : tenno::range(N))
+	    if (M[i*N + j] != T[j*N + i])
+	      {
+	        ASSERT(false);
+		return;
+	      }
+}